@@ -0,0 +1,71 @@
+/**
+ * @file bfp_compress.h
+ * @brief block floating point (BFP) compression of the decimator output
+ *
+ * @details
+ *  The ssr complex samples of an output block (16 values re/im) share one exponent:
+ *  - width:    number of bits of the largest value of the block (two's complement, sign included)
+ *  - exponent: e = max(0, width - mant_bits)
+ *  - mantissa: m = x >> e (arithmetic shift, i.e. truncation towards minus infinity)
+ *  The decompressed sample is m * 2^e (m << e): blocks with small values are exact, the error of the other blocks
+ *  is less than 2^e lsb. With 8-bit mantissas the output block is 8 + 16 x 8 = 136 bits instead of 256 bits.
+ *
+ *  The width is computed like a leading-sign-bit count: the values are folded to non-negative (x ^ (x >> 15)),
+ *  OR-ed together, and the position of the leading one gives the width of the block.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef BFP_COMPRESS_H_
+#define BFP_COMPRESS_H_
+
+#include "ssr_multistage_decimator.h"
+
+/**
+ * @brief compress a block of ssr output samples
+ *
+ * @tparam mant_bits  number of bits of the mantissas
+ * @param tdata_i     output samples (dataout_t)
+ * @param tdata_o     BFP block
+ */
+template <int mant_bits>
+void bfp_compress(const cdataout_vec_t<ssr> &tdata_i, bfp_block_t<mant_bits> &tdata_o)
+{
+    // fold the values to non-negative and OR them: the leading one is the leading one of the largest magnitude
+    ap_uint<dataout_bits - 1> mag = 0;
+    for (int i = 0; i < ssr; ++i)
+    {
+#pragma HLS UNROLL
+        ap_int<dataout_bits> re = tdata_i.re[i].range();
+        ap_int<dataout_bits> im = tdata_i.im[i].range();
+        mag |= ap_uint<dataout_bits - 1>(re ^ (re >> (dataout_bits - 1)));
+        mag |= ap_uint<dataout_bits - 1>(im ^ (im >> (dataout_bits - 1)));
+    }
+
+    // width of the block (sign bit included)
+    ap_uint<5> width = 1;
+    for (int b = 0; b < dataout_bits - 1; ++b)
+    {
+#pragma HLS UNROLL
+        if (mag[b])
+        {
+            width = b + 2;
+        }
+    }
+    ap_uint<5> exp = (width > mant_bits) ? ap_uint<5>(width - mant_bits) : ap_uint<5>(0);
+
+    tdata_o.exp = exp;
+    for (int i = 0; i < ssr; ++i)
+    {
+#pragma HLS UNROLL
+        ap_int<dataout_bits> re = tdata_i.re[i].range();
+        ap_int<dataout_bits> im = tdata_i.im[i].range();
+        tdata_o.re[i] = re >> exp;
+        tdata_o.im[i] = im >> exp;
+    }
+}
+
+#endif /* BFP_COMPRESS_H_ */
@@ -9,6 +9,7 @@
  * - dec2       160 -> 80 (decimation factor = 16, SSR = 1)
  * - dec2       80 -> 40 (decimation factor = 32, SSR = 1)
  * - dec2       40 -> 20 (decimation factor = 64, SSR = 1)
+ *   (with IQ_TDM, dec2_ssr1_iq computes the I and Q samples of dec32 and dec64 with the same multipliers)
  *
  *  Prototype filter coefficients:
  *  [-197, 0, 501, 0, -1087, 0, 2079, 0, -3723, 0, 6596, 0, -12793, 0, 41339,
@@ -18,6 +19,8 @@
  * { -0.001503, 0.000000, 0.003822, 0.000000, -0.008293, 0.000000, 0.015862, 0.000000, -0.028404, 0.000000, 0.050323, 0.000000, -0.097603, 0.000000, 0.315392,
  *  0.500000, 0.315392, 0.000000,-0.097603, 0.000000, 0.050323, 0.000000, -0.028404, 0.000000,0.015862, 0.000000, -0.008293, 0.000000, 0.003822, 0.000000,-0.001503};
  *
+ *  The coefficients of the selected word length (COEF_BITS) are in hbf_coefs.h,
+ *  the polyphase components of each stage are extracted from the prototype: P_k(c) = h(M c + k), M = SSR of the stage.
  *
  * @author marco.pausini@gmail.com
  * @date 2023-11-xy
@@ -27,6 +30,48 @@
 
 #include "ssr_multistage_decimator.h"
 #include "mac_engines.h"
+#include "hbf_coefs.h"
+
+#if defined(SSR_FFA) && defined(_DEBUG_)
+#error "SSR_FFA computes only the outputs kept by the decimation, undefine _DEBUG_"
+#endif
+
+// ---------------------------------------------------------------------------------------------
+// fs/4 frequency shift: x(n) j^(s n), s = +1 or -1
+//
+// j^(s n) only takes the values 1, j, -1, -j, so the shift is a swap of I/Q and sign changes, no multiplier:
+// * j^0 x = ( re,  im)
+// * j^1 x = (-im,  re)
+// * j^2 x = (-re, -im)
+// * j^3 x = ( im, -re)
+// In a stage with SSR = 8 or 4, lane i carries the samples n = SSR m + i, so j^(s n) = j^(s i) is fixed per lane.
+// The negation saturates (-(-1.0) = 1.0 - 2^-15).
+// ---------------------------------------------------------------------------------------------
+template <int fs4_shift>
+cdata_t fs4_rotate(cdata_t x, int lane)
+{
+#pragma HLS INLINE
+    cdata_t y;
+    switch ((fs4_shift * lane) & 3)
+    {
+    case 1:
+        y.re = data_sat_t(-x.im);
+        y.im = x.re;
+        break;
+    case 2:
+        y.re = data_sat_t(-x.re);
+        y.im = data_sat_t(-x.im);
+        break;
+    case 3:
+        y.re = x.im;
+        y.im = data_sat_t(-x.re);
+        break;
+    default:
+        y = x;
+        break;
+    }
+    return y;
+}
 
 // ---------------------------------------------------------------------------------------------
 // dec2_ssr8: 1280 -> 640 ( overal decimation factor = 2, SSR = 8)
@@ -57,53 +102,189 @@
 // Y5(z^8) = ... y(5), y(13), ... = tdata_o[5], X5(z^8) = ... x(5), x(13), ... = tdata_i[5]
 // Y6(z^8) = ... y(6), y(14), ... = tdata_o[6], X6(z^8) = ... x(6), x(14), ... = tdata_i[6]
 // Y7(z^8) = ... y(7), y(15), ... = tdata_o[7], X7(z^8) = ... x(7), x(15), ... = tdata_i[7]
+// the input is shifted by dec2_fs4_shift x fs/4 (DEC2_FS4_SHIFT, 0: no shift)
 // ---------------------------------------------------------------------------------------------
 
-void dec2_ssr8(bool tvalid_i, cdatain_vec_t<8> tdata_i, bool &tvalid_o, cdata_vec_t<8> &tdata_o)
+void dec2_ssr8(bool tvalid_i, cdatain_vec_t<8> tdata_i, bool phase_reset_i, bool &tvalid_o, cdata_vec_t<8> &tdata_o, bool &phase_reset_o)
 {
 
 //#pragma HLS INLINE off
 
     constexpr unsigned int num_coef = 4;
-    const coef_int_t coeff_vec[8][num_coef] = {
-        {-197, -3723, 41339, 2079},
-        {0, 0, 0, 0},
-        {501, 6596, -12793, -1087},
-        {0, 0, 0, 0},
-        {-1087, -12793, 6596, 501},
-        {0, 0, 0, 0},
-        {2079, 41339, -3723, -197},
-        {0, 65536, 0, 0}};
+    // polyphase decomposition coefficients: coeff_vec[k][c] = h(8 c + k)
+    // (18 bits: {-197, -3723, 41339, 2079}, 0, {501, 6596, -12793, -1087}, 0, {-1087, -12793, 6596, 501}, 0, {2079, 41339, -3723, -197}, {0, 65536, 0, 0})
+    coef_int_t coeff_vec[8][num_coef];
+    for (int k = 0; k < 8; ++k)
+    {
+        for (int c = 0; c < num_coef; ++c)
+        {
+            coeff_vec[k][c] = (8 * c + k < hbf_num_taps) ? hbf_coef[8 * c + k] : 0;
+        }
+    }
 
     constexpr unsigned int latency_phase_combiner = 1;
     constexpr unsigned int latency = num_coef + latency_phase_combiner;
 
-    // shift registers to align valid to the module output (consider if 1 extra clock is needed for the final sum)
+    // shift registers to align valid and phase reset to the module output (consider if 1 extra clock is needed for the final sum)
     static ap_shift_reg<bool, latency> vld_shftreg;
+    static ap_shift_reg<bool, latency> phase_shftreg;
 
     // ---------------------------------------------
     // control the shift register of the mac engine
     // ----------------------------------------------
-    static bool skip = false;
     // whether the filter memory is updated with the sample at its input, or it is maintained in the current state
+    // (the delay line only moves on valid inputs, so the output does not depend on the gaps of the input)
     bool toshift_v = tvalid_i;
-    // valid output
-    bool tvalid_v = (tvalid_i && !skip);
+    // valid output: the decimation keeps the even lanes of every input word, so every valid input word
+    // produces an output word and the stage has no decimation phase of its own
+    bool tvalid_v = tvalid_i;
 
-    // align the valid signal to the output
+    // align the valid signal and the phase reset marker to the output
     tvalid_o = vld_shftreg.shift(tvalid_v, latency - 1);
+    phase_reset_o = phase_shftreg.shift(tvalid_v && phase_reset_i, latency - 1);
 
-    // input samples - cast data types
+    // input samples - cast data types, fs/4 shift
     cdata_t tdata_vi[8];
     for (int i = 0; i < 8; ++i)
 #pragma HLS UNROLL
     {
-        tdata_vi[i].re = tdata_i.re[i];
-        tdata_vi[i].im = tdata_i.im[i];
+        cdata_t x;
+        x.re = tdata_i.re[i];
+        x.im = tdata_i.im[i];
+        tdata_vi[i] = fs4_rotate<dec2_fs4_shift>(x, i);
     }
 
     cacc_t acc[8];
 
+#ifdef SSR_FFA
+    // ------------------------------------------------------
+    // fast FIR algorithm (FFA), iterated 2-parallel FFA:
+    // the even outputs only depend on the even prototype taps (G) and on the center tap (P7 = {0, 0.5, 0, 0}), so
+    // with U_i = X_(2i) (even input samples), V_i = X_(2i+1) (odd input samples) and W_i = Y_(2i):
+    //   W(z) = G(z) U(z) + (z^-8) P7 V(z), G(z) = G0(z^4) + z^-1 G1(z^4) + z^-2 G2(z^4) + z^-3 G3(z^4), G_k = P_(2k)
+    // G U is a 4-parallel FIR filter: 16 sub-filters in direct form (G_k U_j), 9 with the FFA:
+    //   e0 = G0 U0, e2 = G2 U2, e02 = (G0 + G2)(U0 + U2)
+    //   e1 = G1 U1, e3 = G3 U3, e13 = (G1 + G3)(U1 + U3)
+    //   e01 = (G0 + G1)(U0 + U1), e23 = (G2 + G3)(U2 + U3), eall = (G0 + G1 + G2 + G3)(U0 + U1 + U2 + U3)
+    // then (omitting the term z^4 for clarity, M1 = e02 - e0 - e2, N1 = e13 - e1 - e3, S1 = eall - e01 - e23)
+    // * W0 = e0 + (z^-8){e2 + N1 + P7 V0}
+    // * W1 = e01 - e0 - e1 + (z^-8){e23 - e2 - e3 + P7 V1}
+    // * W2 = M1 + e1 + (z^-8){e3 + P7 V2}
+    // * W3 = S1 - M1 - N1 + (z^-8){P7 V3}
+    // ------------------------------------------------------
+    constexpr unsigned int num_sub = 9;
+
+    // the center tap is the only non-zero coefficient of P7, at position center_taps - 1: its chain stops there,
+    // and its output is delayed by the registers of the missing taps (the accumulator of a zero tap only delays)
+    constexpr unsigned int center_taps = (hbf_num_taps / 2) / 8 + 1;
+    constexpr unsigned int center_delay = num_coef - center_taps;
+    static_assert(center_delay > 0, "the center tap chain must be shorter than the sub-filters");
+    static ap_shift_reg<cffa_acc_t, center_delay> center_shftreg[4];
+
+    // sub-filter coefficients: G0, G2, G0 + G2, G1, G3, G1 + G3, G0 + G1, G2 + G3, G0 + G1 + G2 + G3
+    ffa_coef_int_t sub_coef[num_sub][num_coef];
+    ffa_coef_int_t center_coef[center_taps];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        sub_coef[0][c] = coeff_vec[0][c];
+        sub_coef[1][c] = coeff_vec[4][c];
+        sub_coef[2][c] = coeff_vec[0][c] + coeff_vec[4][c];
+        sub_coef[3][c] = coeff_vec[2][c];
+        sub_coef[4][c] = coeff_vec[6][c];
+        sub_coef[5][c] = coeff_vec[2][c] + coeff_vec[6][c];
+        sub_coef[6][c] = coeff_vec[0][c] + coeff_vec[2][c];
+        sub_coef[7][c] = coeff_vec[4][c] + coeff_vec[6][c];
+        sub_coef[8][c] = coeff_vec[0][c] + coeff_vec[2][c] + coeff_vec[4][c] + coeff_vec[6][c];
+    }
+    for (int c = 0; c < center_taps; ++c)
+    {
+        center_coef[c] = coeff_vec[7][c];
+    }
+
+    // pre-additions
+    cffa_data_t u[4];
+    cffa_data_t v[4];
+    for (int i = 0; i < 4; ++i)
+#pragma HLS UNROLL
+    {
+        u[i].re = tdata_vi[2 * i].re;
+        u[i].im = tdata_vi[2 * i].im;
+        v[i].re = tdata_vi[2 * i + 1].re;
+        v[i].im = tdata_vi[2 * i + 1].im;
+    }
+    cffa_data_t u02 = ffa_add(u[0], u[2]);
+    cffa_data_t u13 = ffa_add(u[1], u[3]);
+    cffa_data_t u01 = ffa_add(u[0], u[1]);
+    cffa_data_t u23 = ffa_add(u[2], u[3]);
+    cffa_data_t uall = ffa_add(u01, u23);
+
+    // sub-filters
+    cffa_acc_t e0 = multi_mac_systolic<0, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u[0], sub_coef[0]);
+    cffa_acc_t e2 = multi_mac_systolic<1, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u[2], sub_coef[1]);
+    cffa_acc_t e02 = multi_mac_systolic<2, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u02, sub_coef[2]);
+    cffa_acc_t e1 = multi_mac_systolic<3, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u[1], sub_coef[3]);
+    cffa_acc_t e3 = multi_mac_systolic<4, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u[3], sub_coef[4]);
+    cffa_acc_t e13 = multi_mac_systolic<5, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u13, sub_coef[5]);
+    cffa_acc_t e01 = multi_mac_systolic<6, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u01, sub_coef[6]);
+    cffa_acc_t e23 = multi_mac_systolic<7, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u23, sub_coef[7]);
+    cffa_acc_t eall = multi_mac_systolic<8, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, uall, sub_coef[8]);
+
+    // center tap (P7 V_i), aligned to the sub-filters
+    cffa_acc_t ec[4];
+    ec[0] = multi_mac_systolic<9, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, v[0], center_coef);
+    ec[1] = multi_mac_systolic<10, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, v[1], center_coef);
+    ec[2] = multi_mac_systolic<11, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, v[2], center_coef);
+    ec[3] = multi_mac_systolic<12, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, v[3], center_coef);
+    for (int i = 0; i < 4; ++i)
+#pragma HLS UNROLL
+    {
+        ec[i] = center_shftreg[i].shift(ec[i], center_delay - 1);
+    }
+
+    // post-additions
+    cffa_acc_t m1 = ffa_sub(ffa_sub(e02, e0), e2);
+    cffa_acc_t n1 = ffa_sub(ffa_sub(e13, e1), e3);
+    cffa_acc_t s1 = ffa_sub(ffa_sub(eall, e01), e23);
+
+    // tdata_o[0] = W0
+    acc[0] = ffa_combiner<0>(e0, ffa_add(ffa_add(e2, n1), ec[0]));
+    // tdata_o[1] = W1
+    acc[2] = ffa_combiner<1>(ffa_sub(ffa_sub(e01, e0), e1), ffa_add(ffa_sub(ffa_sub(e23, e2), e3), ec[1]));
+    // tdata_o[2] = W2
+    acc[4] = ffa_combiner<2>(ffa_add(m1, e1), ffa_add(e3, ec[2]));
+    // tdata_o[3] = W3
+    acc[6] = ffa_combiner<3>(ffa_sub(ffa_sub(s1, m1), n1), ec[3]);
+#else
+    // ------------------------------------------------------
+    // shared tapped delay line per input lane:
+    // lane X_j feeds the polyphase branch P_((k - j) mod 8) of every computed output Y_k.
+    // The lane history is stored once and fans out to the branches of all the outputs,
+    // instead of one delay line per (lane, output) pair.
+    // ------------------------------------------------------
+#ifdef _DEBUG_
+    // compute all the outputs
+    constexpr unsigned int num_out = 8;
+    constexpr unsigned int out_step = 1;
+#else
+    // compute only the even outputs - the odd outputs are discarded by the decimation process
+    constexpr unsigned int num_out = 4;
+    constexpr unsigned int out_step = 2;
+#endif
+
+    // coefficients of the branches driven by each lane: lane_coef[j][k] = P_((out_step * k - j) mod 8)
+    coef_int_t lane_coef[8][num_out][num_coef];
+    for (int j = 0; j < 8; ++j)
+#pragma HLS UNROLL
+    {
+        for (int k = 0; k < num_out; ++k)
+        {
+            for (int c = 0; c < num_coef; ++c)
+            {
+                lane_coef[j][k][c] = coeff_vec[(out_step * k - j) & 7][c];
+            }
+        }
+    }
+
     // ------------------------------------------------------
     // ------ !!! ----------------- !!! --------------------
     // not possible to create a loop because template instantiation
@@ -112,110 +293,46 @@ void dec2_ssr8(bool tvalid_i, cdatain_vec_t<8> tdata_i, bool &tvalid_o, cdata_ve
     // ------ !!! ----------------- !!! --------------------
     // ------------------------------------------------------
 
-    // compute tdata_o[0] = Y0(z^8) = P0 X0 + (z^-8){P7 X1 + P6 X2 + P5 X3 + P4 X4 + P3 X5 + P2 X6 + P1 X7}
-    cacc_t acc0[8];
-    acc0[0] = multi_mac_systolic<0, num_coef>(toshift_v, tdata_vi[0], coeff_vec[0]); // P0(z^8) X0(z^8)
-    acc0[1] = multi_mac_systolic<1, num_coef>(toshift_v, tdata_vi[1], coeff_vec[7]); // P7(z^8) X1(z^8)
-    acc0[2] = multi_mac_systolic<2, num_coef>(toshift_v, tdata_vi[2], coeff_vec[6]); // P6(z^8) X2(z^8)
-    acc0[3] = multi_mac_systolic<3, num_coef>(toshift_v, tdata_vi[3], coeff_vec[5]); // P5(z^8) X3(z^8)
-    acc0[4] = multi_mac_systolic<4, num_coef>(toshift_v, tdata_vi[4], coeff_vec[4]); // P4(z^8) X4(z^8)
-    acc0[5] = multi_mac_systolic<5, num_coef>(toshift_v, tdata_vi[5], coeff_vec[3]); // P3(z^8) X5(z^8)
-    acc0[6] = multi_mac_systolic<6, num_coef>(toshift_v, tdata_vi[6], coeff_vec[2]); // P2(z^8) X6(z^8)
-    acc0[7] = multi_mac_systolic<7, num_coef>(toshift_v, tdata_vi[7], coeff_vec[1]); // P1(z^8) X7(z^8)
-
-    acc[0] = phase_combiner<0, 8, 1, 7>(acc0);
-
-    // compute tdata_o[2] = Y2(z^8) = P2 X0 + P1 X1 + P0 X2 + (z^-8){P7 X3 + P6 X4 + P5 X5 + P4 X6 + P3 X7}
-    cacc_t acc2[8];
-    acc2[0] = multi_mac_systolic<16, num_coef>(toshift_v, tdata_vi[0], coeff_vec[2]); // P2(z^8) X0(z^8)
-    acc2[1] = multi_mac_systolic<17, num_coef>(toshift_v, tdata_vi[1], coeff_vec[1]); // P1(z^8) X1(z^8)
-    acc2[2] = multi_mac_systolic<18, num_coef>(toshift_v, tdata_vi[2], coeff_vec[0]); // P0(z^8) X2(z^8)
-    acc2[3] = multi_mac_systolic<19, num_coef>(toshift_v, tdata_vi[3], coeff_vec[7]); // P7(z^8) X3(z^8)
-    acc2[4] = multi_mac_systolic<20, num_coef>(toshift_v, tdata_vi[4], coeff_vec[6]); // P6(z^8) X4(z^8)
-    acc2[5] = multi_mac_systolic<21, num_coef>(toshift_v, tdata_vi[5], coeff_vec[5]); // P5(z^8) X5(z^8)
-    acc2[6] = multi_mac_systolic<22, num_coef>(toshift_v, tdata_vi[6], coeff_vec[4]); // P4(z^8) X6(z^8)
-    acc2[7] = multi_mac_systolic<23, num_coef>(toshift_v, tdata_vi[7], coeff_vec[3]); // P3(z^8) X7(z^8)
-
-    acc[2] = phase_combiner<5, 8, 3, 5>(acc2);
-
-    // compute tdata_o[4] = Y4(z^8) = P4 X0 + P3 X1 + P2 X2 + P1 X3 + P0 X4 + (z^-8){P7 X5 + P6 X6 + P5 X7}
-    cacc_t acc4[8];
-    acc4[0] = multi_mac_systolic<32, num_coef>(toshift_v, tdata_vi[0], coeff_vec[4]); // P4(z^8) X0(z^8)
-    acc4[1] = multi_mac_systolic<33, num_coef>(toshift_v, tdata_vi[1], coeff_vec[3]); // P3(z^8) X1(z^8)
-    acc4[2] = multi_mac_systolic<34, num_coef>(toshift_v, tdata_vi[2], coeff_vec[2]); // P2(z^8) X2(z^8)
-    acc4[3] = multi_mac_systolic<35, num_coef>(toshift_v, tdata_vi[3], coeff_vec[1]); // P1(z^8) X3(z^8)
-    acc4[4] = multi_mac_systolic<36, num_coef>(toshift_v, tdata_vi[4], coeff_vec[0]); // P0(z^8) X4(z^8)
-    acc4[5] = multi_mac_systolic<37, num_coef>(toshift_v, tdata_vi[5], coeff_vec[7]); // P7(z^8) X5(z^8)
-    acc4[6] = multi_mac_systolic<38, num_coef>(toshift_v, tdata_vi[6], coeff_vec[6]); // P6(z^8) X6(z^8)
-    acc4[7] = multi_mac_systolic<39, num_coef>(toshift_v, tdata_vi[7], coeff_vec[5]); // P5(z^8) X7(z^8)
-
-    acc[4] = phase_combiner<3, 8, 5, 3>(acc4);
-
-    // compute tdata_o[6] = Y6(z^8) = P6 X0 + P5 X1 + P4 X2 + P3 X3 + P2 X4 + P1 X5 + P0 X6 + (z^-8)P7 X7
-    cacc_t acc6[8];
-    acc6[0] = multi_mac_systolic<48, num_coef>(toshift_v, tdata_vi[0], coeff_vec[6]); // P6(z^8) X0(z^8)
-    acc6[1] = multi_mac_systolic<49, num_coef>(toshift_v, tdata_vi[1], coeff_vec[5]); // P5(z^8) X1(z^8)
-    acc6[2] = multi_mac_systolic<50, num_coef>(toshift_v, tdata_vi[2], coeff_vec[4]); // P4(z^8) X2(z^8)
-    acc6[3] = multi_mac_systolic<51, num_coef>(toshift_v, tdata_vi[3], coeff_vec[3]); // P3(z^8) X3(z^8)
-    acc6[4] = multi_mac_systolic<52, num_coef>(toshift_v, tdata_vi[4], coeff_vec[2]); // P2(z^8) X4(z^8)
-    acc6[5] = multi_mac_systolic<53, num_coef>(toshift_v, tdata_vi[5], coeff_vec[1]); // P1(z^8) X5(z^8)
-    acc6[6] = multi_mac_systolic<54, num_coef>(toshift_v, tdata_vi[6], coeff_vec[0]); // P0(z^8) X6(z^8)
-    acc6[7] = multi_mac_systolic<55, num_coef>(toshift_v, tdata_vi[7], coeff_vec[7]); // P7(z^8) X7(z^8)
-
-    acc[6] = phase_combiner<1, 8, 7, 1>(acc6);
+    cacc_t lane_acc[8][num_out];
+    multi_mac_systolic_shared<0, num_coef, num_out>(toshift_v, tdata_vi[0], lane_coef[0], lane_acc[0]); // X0(z^8)
+    multi_mac_systolic_shared<1, num_coef, num_out>(toshift_v, tdata_vi[1], lane_coef[1], lane_acc[1]); // X1(z^8)
+    multi_mac_systolic_shared<2, num_coef, num_out>(toshift_v, tdata_vi[2], lane_coef[2], lane_acc[2]); // X2(z^8)
+    multi_mac_systolic_shared<3, num_coef, num_out>(toshift_v, tdata_vi[3], lane_coef[3], lane_acc[3]); // X3(z^8)
+    multi_mac_systolic_shared<4, num_coef, num_out>(toshift_v, tdata_vi[4], lane_coef[4], lane_acc[4]); // X4(z^8)
+    multi_mac_systolic_shared<5, num_coef, num_out>(toshift_v, tdata_vi[5], lane_coef[5], lane_acc[5]); // X5(z^8)
+    multi_mac_systolic_shared<6, num_coef, num_out>(toshift_v, tdata_vi[6], lane_coef[6], lane_acc[6]); // X6(z^8)
+    multi_mac_systolic_shared<7, num_coef, num_out>(toshift_v, tdata_vi[7], lane_coef[7], lane_acc[7]); // X7(z^8)
+
+    // regroup the branch outputs per polyphase output: acc_ph[k][j] = P_((k - j) mod 8) X_j
+    cacc_t acc_ph[8][8];
+    for (int k = 0; k < num_out; ++k)
+#pragma HLS UNROLL
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            acc_ph[out_step * k][j] = lane_acc[j][k];
+        }
+    }
+
+    // tdata_o[0] = Y0(z^8) = P0 X0 + (z^-8){P7 X1 + P6 X2 + P5 X3 + P4 X4 + P3 X5 + P2 X6 + P1 X7}
+    acc[0] = phase_combiner<0, 8, 1, 7>(acc_ph[0]);
+    // tdata_o[2] = Y2(z^8) = P2 X0 + P1 X1 + P0 X2 + (z^-8){P7 X3 + P6 X4 + P5 X5 + P4 X6 + P3 X7}
+    acc[2] = phase_combiner<5, 8, 3, 5>(acc_ph[2]);
+    // tdata_o[4] = Y4(z^8) = P4 X0 + P3 X1 + P2 X2 + P1 X3 + P0 X4 + (z^-8){P7 X5 + P6 X6 + P5 X7}
+    acc[4] = phase_combiner<3, 8, 5, 3>(acc_ph[4]);
+    // tdata_o[6] = Y6(z^8) = P6 X0 + P5 X1 + P4 X2 + P3 X3 + P2 X4 + P1 X5 + P0 X6 + (z^-8)P7 X7
+    acc[6] = phase_combiner<1, 8, 7, 1>(acc_ph[6]);
+#endif
 
 #ifdef _DEBUG_
-    // compute tdata_o[1] = Y1(z^8) = P1 X0 + P0 X1  + (z^-8){P7 X2 + P6 X3 + P5 X4 + P4 X5 + P3 X6 + P2 X7}
-    cacc_t acc1[8];
-    acc1[0] = multi_mac_systolic<8, num_coef>(toshift_v, tdata_vi[0], coeff_vec[1]);  // P1(z^8) X0(z^8)
-    acc1[1] = multi_mac_systolic<9, num_coef>(toshift_v, tdata_vi[1], coeff_vec[0]);  // P0(z^8) X1(z^8)
-    acc1[2] = multi_mac_systolic<10, num_coef>(toshift_v, tdata_vi[2], coeff_vec[7]); // P7(z^8) X2(z^8)
-    acc1[3] = multi_mac_systolic<11, num_coef>(toshift_v, tdata_vi[3], coeff_vec[6]); // P6(z^8) X3(z^8)
-    acc1[4] = multi_mac_systolic<12, num_coef>(toshift_v, tdata_vi[4], coeff_vec[5]); // P5(z^8) X4(z^8)
-    acc1[5] = multi_mac_systolic<13, num_coef>(toshift_v, tdata_vi[5], coeff_vec[4]); // P4(z^8) X5(z^8)
-    acc1[6] = multi_mac_systolic<14, num_coef>(toshift_v, tdata_vi[6], coeff_vec[3]); // P3(z^8) X6(z^8)
-    acc1[7] = multi_mac_systolic<15, num_coef>(toshift_v, tdata_vi[7], coeff_vec[2]); // P2(z^8) X7(z^8)
-
-    acc[1] = phase_combiner<6, 8, 2, 6>(acc1);
-
-    // compute tdata_o[3] = Y3(z^8) = P3 X0 + P2 X1 + P1 X2 + P0 X3 + (z^-8){P7 X4 + P6 X5 + P5 X6 + P4 X7}
-    cacc_t acc3[8];
-    acc3[0] = multi_mac_systolic<24, num_coef>(toshift_v, tdata_vi[0], coeff_vec[3]); // P3(z^8) X0(z^8)
-    acc3[1] = multi_mac_systolic<25, num_coef>(toshift_v, tdata_vi[1], coeff_vec[2]); // P2(z^8) X1(z^8)
-    acc3[2] = multi_mac_systolic<26, num_coef>(toshift_v, tdata_vi[2], coeff_vec[1]); // P1(z^8) X2(z^8)
-    acc3[3] = multi_mac_systolic<27, num_coef>(toshift_v, tdata_vi[3], coeff_vec[0]); // P0(z^8) X3(z^8)
-    acc3[4] = multi_mac_systolic<28, num_coef>(toshift_v, tdata_vi[4], coeff_vec[7]); // P7(z^8) X4(z^8)
-    acc3[5] = multi_mac_systolic<29, num_coef>(toshift_v, tdata_vi[5], coeff_vec[6]); // P6(z^8) X5(z^8)
-    acc3[6] = multi_mac_systolic<30, num_coef>(toshift_v, tdata_vi[6], coeff_vec[5]); // P5(z^8) X6(z^8)
-    acc3[7] = multi_mac_systolic<31, num_coef>(toshift_v, tdata_vi[7], coeff_vec[4]); // P4(z^8) X7(z^8)
-
-    acc[3] = phase_combiner<4, 8, 4, 4>(acc3);
-
-    // compute tdata_o[5] = Y5(z^8) = P5 X0 + P4 X1 + P3 X2 + P2 X3 + P1 X4 + P0 X5 + (z^-8){P7 X6 + P6 X7}
-    cacc_t acc5[8];
-    acc5[0] = multi_mac_systolic<40, num_coef>(toshift_v, tdata_vi[0], coeff_vec[5]); // P5(z^8) X0(z^8)
-    acc5[1] = multi_mac_systolic<41, num_coef>(toshift_v, tdata_vi[1], coeff_vec[4]); // P4(z^8) X1(z^8)
-    acc5[2] = multi_mac_systolic<42, num_coef>(toshift_v, tdata_vi[2], coeff_vec[3]); // P3(z^8) X2(z^8)
-    acc5[3] = multi_mac_systolic<43, num_coef>(toshift_v, tdata_vi[3], coeff_vec[2]); // P2(z^8) X3(z^8)
-    acc5[4] = multi_mac_systolic<44, num_coef>(toshift_v, tdata_vi[4], coeff_vec[1]); // P1(z^8) X4(z^8)
-    acc5[5] = multi_mac_systolic<45, num_coef>(toshift_v, tdata_vi[5], coeff_vec[0]); // P0(z^8) X5(z^8)
-    acc5[6] = multi_mac_systolic<46, num_coef>(toshift_v, tdata_vi[6], coeff_vec[7]); // P7(z^8) X6(z^8)
-    acc5[7] = multi_mac_systolic<47, num_coef>(toshift_v, tdata_vi[7], coeff_vec[6]); // P6(z^8) X7(z^8)
-
-    acc[5] = phase_combiner<2, 8, 6, 2>(acc5);
-
-    // compute tdata_o[7] = Y7(z^8) = P7 X0 + P6 X1 + P5 X2 + P4 X3 + P3 X4 + P2 X5 + P1 X6 + P0 X7
-    cacc_t acc7[8];
-    acc7[0] = multi_mac_systolic<56, num_coef>(toshift_v, tdata_vi[0], coeff_vec[7]); // P7(z^8) X0(z^8)
-    acc7[1] = multi_mac_systolic<57, num_coef>(toshift_v, tdata_vi[1], coeff_vec[6]); // P6(z^8) X1(z^8)
-    acc7[2] = multi_mac_systolic<58, num_coef>(toshift_v, tdata_vi[2], coeff_vec[5]); // P5(z^8) X2(z^8)
-    acc7[3] = multi_mac_systolic<59, num_coef>(toshift_v, tdata_vi[3], coeff_vec[4]); // P4(z^8) X3(z^8)
-    acc7[4] = multi_mac_systolic<60, num_coef>(toshift_v, tdata_vi[4], coeff_vec[3]); // P3(z^8) X4(z^8)
-    acc7[5] = multi_mac_systolic<61, num_coef>(toshift_v, tdata_vi[5], coeff_vec[2]); // P2(z^8) X5(z^8)
-    acc7[6] = multi_mac_systolic<62, num_coef>(toshift_v, tdata_vi[6], coeff_vec[1]); // P1(z^8) X6(z^8)
-    acc7[7] = multi_mac_systolic<63, num_coef>(toshift_v, tdata_vi[7], coeff_vec[0]); // P0(z^8) X7(z^8)
-
-    acc[7] = phase_combiner<0, 8, 8, 0>(acc7);
+    // tdata_o[1] = Y1(z^8) = P1 X0 + P0 X1  + (z^-8){P7 X2 + P6 X3 + P5 X4 + P4 X5 + P3 X6 + P2 X7}
+    acc[1] = phase_combiner<6, 8, 2, 6>(acc_ph[1]);
+    // tdata_o[3] = Y3(z^8) = P3 X0 + P2 X1 + P1 X2 + P0 X3 + (z^-8){P7 X4 + P6 X5 + P5 X6 + P4 X7}
+    acc[3] = phase_combiner<4, 8, 4, 4>(acc_ph[3]);
+    // tdata_o[5] = Y5(z^8) = P5 X0 + P4 X1 + P3 X2 + P2 X3 + P1 X4 + P0 X5 + (z^-8){P7 X6 + P6 X7}
+    acc[5] = phase_combiner<2, 8, 6, 2>(acc_ph[5]);
+    // tdata_o[7] = Y7(z^8) = P7 X0 + P6 X1 + P5 X2 + P4 X3 + P3 X4 + P2 X5 + P1 X6 + P0 X7
+    acc[7] = phase_combiner<0, 8, 8, 0>(acc_ph[7]);
 
     // assign outputs
     for (int i = 0; i < 8; ++i)
@@ -258,67 +375,157 @@ void dec2_ssr8(bool tvalid_i, cdatain_vec_t<8> tdata_i, bool &tvalid_o, cdata_ve
 // Y1(z^4) = ... y(1), y(5) ... = tdata_o[1], X1(z^4) = ... x(1), x(5), .... = tdata_i[1]
 // Y2(z^4) = ... y(2), y(6) ... = tdata_o[2], X2(z^4) = ... x(2), x(6), .... = tdata_i[2]
 // Y3(z^4) = ... y(3), y(7) ... = tdata_o[3], X3(z^4) = ... x(3), x(7), .... = tdata_i[3]
+// the input is shifted by dec4_fs4_shift x fs/4 (DEC4_FS4_SHIFT, 0: no shift)
 // ---------------------------------------------------------------------------------------------
 
-void dec2_ssr4(bool tvalid_i, cdata_vec_t<4> tdata_i, bool &tvalid_o, cdata_vec_t<4> &tdata_o)
+void dec2_ssr4(bool tvalid_i, cdata_vec_t<4> tdata_i, bool phase_reset_i, bool &tvalid_o, cdata_vec_t<4> &tdata_o, bool &phase_reset_o)
 {
 
 //#pragma HLS INLINE off
 
     constexpr unsigned int num_coef = 8;
-    // polyphase decomposition coefficients
-    const coef_int_t coeff_vec0[num_coef] = {-197, -1087, -3723, -12793, 41339, 6596,  2079,   501};
-    const coef_int_t coeff_vec1[num_coef] = {   0,     0,     0,     0,      0,    0,     0,     0};
-    const coef_int_t coeff_vec2[num_coef] = {  501, 2079,  6596, 41339, -12793, -3723, -1087,  -197};
-    const coef_int_t coeff_vec3[num_coef] = {    0,    0,     0, 65536,      0,     0,     0,     0};
+    // polyphase decomposition coefficients: coeff_vec[k][c] = h(4 c + k)
+    // (18 bits: {-197, -1087, -3723, -12793, 41339, 6596, 2079, 501}, 0, {501, 2079, 6596, 41339, -12793, -3723, -1087, -197}, {0, 0, 0, 65536, 0, 0, 0, 0})
+    coef_int_t coeff_vec[4][num_coef];
+    for (int k = 0; k < 4; ++k)
+    {
+        for (int c = 0; c < num_coef; ++c)
+        {
+            coeff_vec[k][c] = (4 * c + k < hbf_num_taps) ? hbf_coef[4 * c + k] : 0;
+        }
+    }
 
     constexpr unsigned int latency_phase_combiner = 1;
     constexpr unsigned int latency = num_coef + latency_phase_combiner;
 
-    // shift registers to align valid to the module output (consider if 1 extra clock is needed for the final sum)
+    // shift registers to align valid and phase reset to the module output (consider if 1 extra clock is needed for the final sum)
     static ap_shift_reg<bool, latency> vld_shftreg;
+    static ap_shift_reg<bool, latency> phase_shftreg;
 
     // ---------------------------------------------
     // control the shift register of the mac engine
     // ----------------------------------------------
-    static bool skip = false;
     // whether the filter memory is updated with the sample at its input, or it is maintained in the current state
+    // (the delay line only moves on valid inputs, so the output does not depend on the gaps of the input)
     bool toshift_v = tvalid_i;
-    // valid output
-    bool tvalid_v = (tvalid_i && !skip);
+    // valid output: the decimation keeps the even lanes of every input word, so every valid input word
+    // produces an output word and the stage has no decimation phase of its own
+    bool tvalid_v = tvalid_i;
 
-    // align the valid signal to the output
+    // align the valid signal and the phase reset marker to the output
     tvalid_o = vld_shftreg.shift(tvalid_v, latency - 1);
+    phase_reset_o = phase_shftreg.shift(tvalid_v && phase_reset_i, latency - 1);
 
-    // input sample
+    // input sample, fs/4 shift
     cdata_t tdata_vi[4];
 
     for (int i = 0; i < 4; ++i)
 #pragma HLS UNROLL
     {
-        tdata_vi[i].re = tdata_i.re[i];
-        tdata_vi[i].im = tdata_i.im[i];
+        cdata_t x;
+        x.re = tdata_i.re[i];
+        x.im = tdata_i.im[i];
+        tdata_vi[i] = fs4_rotate<dec4_fs4_shift>(x, i);
     }
 
     cacc_t acc[4];
 
-    // compute tdata_o[0] = Y0(z^4) = P0 X0 + (z^-4){P3 X1 + P2 X2 + P1 X3}
-    cacc_t acc0[4];
-    acc0[0] = multi_mac_systolic<0, num_coef>(toshift_v, tdata_vi[0], coeff_vec0); // P0(z^4) X0(z^4)
-    acc0[1] = multi_mac_systolic<1, num_coef>(toshift_v, tdata_vi[1], coeff_vec3); // P3(z^4) X1(z^4)
-    acc0[2] = multi_mac_systolic<2, num_coef>(toshift_v, tdata_vi[2], coeff_vec2); // P2(z^4) X2(z^4)
-    acc0[3] = multi_mac_systolic<3, num_coef>(toshift_v, tdata_vi[3], coeff_vec1); // P1(z^4) X3(z^4)
+#ifdef SSR_FFA
+    // ------------------------------------------------------
+    // fast FIR algorithm (FFA), 2-parallel FFA (see dec2_ssr8):
+    // with U0 = X0, U1 = X2 (even input samples), G0 = P0, G1 = P2 and the center tap P3 = {0, 0, 0, 0.5, 0, ...}
+    //   e0 = G0 U0, e1 = G1 U1, e01 = (G0 + G1)(U0 + U1)
+    // * Y0 = e0 + (z^-4){e1 + P3 X1}
+    // * Y2 = e01 - e0 - e1 + (z^-4){P3 X3}
+    // 3 sub-filters instead of 4 in direct form
+    // ------------------------------------------------------
+    // the center tap is the only non-zero coefficient of P3: its chain stops there (see dec2_ssr8)
+    constexpr unsigned int center_taps = (hbf_num_taps / 2) / 4 + 1;
+    constexpr unsigned int center_delay = num_coef - center_taps;
+    static_assert(center_delay > 0, "the center tap chain must be shorter than the sub-filters");
+    static ap_shift_reg<cffa_acc_t, center_delay> center_shftreg[2];
+
+    ffa_coef_int_t sub_coef[3][num_coef];
+    ffa_coef_int_t center_coef[center_taps];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        sub_coef[0][c] = coeff_vec[0][c];
+        sub_coef[1][c] = coeff_vec[2][c];
+        sub_coef[2][c] = coeff_vec[0][c] + coeff_vec[2][c];
+    }
+    for (int c = 0; c < center_taps; ++c)
+    {
+        center_coef[c] = coeff_vec[3][c];
+    }
 
-    acc[0] = phase_combiner<0, 4, 1, 3>(acc0);
+    // pre-additions
+    cffa_data_t x[4];
+    for (int i = 0; i < 4; ++i)
+#pragma HLS UNROLL
+    {
+        x[i].re = tdata_vi[i].re;
+        x[i].im = tdata_vi[i].im;
+    }
+    cffa_data_t u01 = ffa_add(x[0], x[2]);
+
+    // sub-filters
+    cffa_acc_t e0 = multi_mac_systolic<0, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, x[0], sub_coef[0]);
+    cffa_acc_t e1 = multi_mac_systolic<1, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, x[2], sub_coef[1]);
+    cffa_acc_t e01 = multi_mac_systolic<2, num_coef, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, u01, sub_coef[2]);
+
+    // center tap, aligned to the sub-filters (instances 0-12 with the FFA types are used by dec2_ssr8)
+    cffa_acc_t ec1 = multi_mac_systolic<13, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, x[1], center_coef);
+    cffa_acc_t ec3 = multi_mac_systolic<14, center_taps, cffa_data_t, ffa_coef_t, cffa_acc_t>(toshift_v, x[3], center_coef);
+    ec1 = center_shftreg[0].shift(ec1, center_delay - 1);
+    ec3 = center_shftreg[1].shift(ec3, center_delay - 1);
+
+    // tdata_o[0] = Y0(z^4) (ffa_combiner instances 0-3 are used by dec2_ssr8)
+    acc[0] = ffa_combiner<4>(e0, ffa_add(e1, ec1));
+    // tdata_o[1] = Y2(z^4)
+    acc[2] = ffa_combiner<5>(ffa_sub(ffa_sub(e01, e0), e1), ec3);
+#else
+    // ------------------------------------------------------
+    // shared tapped delay line per input lane:
+    // lane X_j feeds the polyphase branch P_((k - j) mod 4) of every computed output Y_k (k = 0, 2)
+    // ------------------------------------------------------
+    constexpr unsigned int num_out = 2;
+
+    // coefficients of the branches driven by each lane: lane_coef[j][k] = P_((2 * k - j) mod 4)
+    coef_int_t lane_coef[4][num_out][num_coef];
+    for (int j = 0; j < 4; ++j)
+#pragma HLS UNROLL
+    {
+        for (int k = 0; k < num_out; ++k)
+        {
+            for (int c = 0; c < num_coef; ++c)
+            {
+                lane_coef[j][k][c] = coeff_vec[(2 * k - j) & 3][c];
+            }
+        }
+    }
+
+    cacc_t lane_acc[4][num_out];
+    multi_mac_systolic_shared<0, num_coef, num_out>(toshift_v, tdata_vi[0], lane_coef[0], lane_acc[0]); // X0(z^4)
+    multi_mac_systolic_shared<1, num_coef, num_out>(toshift_v, tdata_vi[1], lane_coef[1], lane_acc[1]); // X1(z^4)
+    multi_mac_systolic_shared<2, num_coef, num_out>(toshift_v, tdata_vi[2], lane_coef[2], lane_acc[2]); // X2(z^4)
+    multi_mac_systolic_shared<3, num_coef, num_out>(toshift_v, tdata_vi[3], lane_coef[3], lane_acc[3]); // X3(z^4)
 
-    // compute tdata_o[2] = Y2(z^4) = P2 X0 + P1 X1 + P0 X2 + (z^-4){P3 X3}
+    // regroup the branch outputs per polyphase output
+    cacc_t acc0[4];
     cacc_t acc2[4];
-    acc2[0] = multi_mac_systolic<8, num_coef>(toshift_v, tdata_vi[0], coeff_vec2); // P2(z^4) X0(z^4)
-    acc2[1] = multi_mac_systolic<9, num_coef>(toshift_v, tdata_vi[1], coeff_vec1); // P1(z^4) X1(z^4)
-    acc2[2] = multi_mac_systolic<10, num_coef>(toshift_v, tdata_vi[2], coeff_vec0); // P0(z^4) X2(z^4)
-    acc2[3] = multi_mac_systolic<11, num_coef>(toshift_v, tdata_vi[3], coeff_vec3); // P3(z^4) X3(z^4)
+    for (int j = 0; j < 4; ++j)
+#pragma HLS UNROLL
+    {
+        acc0[j] = lane_acc[j][0];
+        acc2[j] = lane_acc[j][1];
+    }
+
+    // tdata_o[0] = Y0(z^4) = P0 X0 + (z^-4){P3 X1 + P2 X2 + P1 X3}
+    acc[0] = phase_combiner<0, 4, 1, 3>(acc0);
 
+    // tdata_o[2] = Y2(z^4) = P2 X0 + P1 X1 + P0 X2 + (z^-4){P3 X3}
     acc[2] = phase_combiner<2, 4, 3, 1>(acc2);
+#endif
 
     for (int i = 0; i < 2; ++i)
     {
@@ -348,33 +555,42 @@ void dec2_ssr4(bool tvalid_i, cdata_vec_t<4> tdata_i, bool &tvalid_o, cdata_vec_
 // Y0(z^2) = ... y(0), y(2), y(4), y(6), ... = tdata_o[0], X0(z^2) = ... x(0), x(2), x(4), x(6), ... = tdata_i[0]
 // Y1(z^2) = ... y(1), y(3), y(5), y(7), ... = tdata_o[1], X1(z^2) = ... x(1), x(3), x(5), x(7), ... = tdata_i[1]
 // ---------------------------------------------------------------------------------------------
-void dec2_ssr2(bool tvalid_i, cdata_vec_t<2> tdata_i, bool &tvalid_o, cdata_vec_t<2> &tdata_o)
+void dec2_ssr2(bool tvalid_i, cdata_vec_t<2> tdata_i, bool phase_reset_i, bool &tvalid_o, cdata_vec_t<2> &tdata_o, bool &phase_reset_o)
 {
 
 //#pragma HLS INLINE off
 
     constexpr unsigned int num_coef = 16;
-    // polyphase decomposition coefficients
-    const coef_int_t coeff_vec0[num_coef] = {-197, 501, -1087, 2079, -3723, 6596, -12793, 41339, 41339, -12793, 6596, -3723, 2079, -1087, 501, -197};
-    const coef_int_t coeff_vec1[num_coef] = {0, 0, 0, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 0, 0, 0, 0};
+    // polyphase decomposition coefficients: coeff_vec0[c] = h(2 c), coeff_vec1[c] = h(2 c + 1)
+    // (18 bits: {-197, 501, -1087, 2079, -3723, 6596, -12793, 41339, 41339, ..., -197}, {0, ..., 0, 65536, 0, ..., 0})
+    coef_int_t coeff_vec0[num_coef];
+    coef_int_t coeff_vec1[num_coef];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        coeff_vec0[c] = hbf_coef[2 * c];
+        coeff_vec1[c] = (2 * c + 1 < hbf_num_taps) ? hbf_coef[2 * c + 1] : 0;
+    }
 
     constexpr unsigned int latency_phase_combiner = 1;
     constexpr unsigned int latency = num_coef + latency_phase_combiner;
 
-    // shift registers to align valid to the module output (consider if 1 extra clock is needed for the final sum)
+    // shift registers to align valid and phase reset to the module output (consider if 1 extra clock is needed for the final sum)
     static ap_shift_reg<bool, (latency)> vld_shftreg;
+    static ap_shift_reg<bool, (latency)> phase_shftreg;
 
     // ---------------------------------------------
     // control the shift register of the mac engine
     // ----------------------------------------------
-    static bool skip = false;
     // whether the filter memory is updated with the sample at its input, or it is maintained in the current state
+    // (the delay line only moves on valid inputs, so the output does not depend on the gaps of the input)
     bool toshift_v = tvalid_i;
-    // valid output
-    bool tvalid_v = (tvalid_i && !skip);
+    // valid output: the decimation keeps the even lanes of every input word, so every valid input word
+    // produces an output word and the stage has no decimation phase of its own
+    bool tvalid_v = tvalid_i;
 
-    // align the valid signal to the output
+    // align the valid signal and the phase reset marker to the output
     tvalid_o = vld_shftreg.shift(tvalid_v, latency - 1);
+    phase_reset_o = phase_shftreg.shift(tvalid_v && phase_reset_i, latency - 1);
 
     // input sample
     cdata_t tdata_vi[2];
@@ -403,17 +619,29 @@ void dec2_ssr2(bool tvalid_i, cdata_vec_t<2> tdata_i, bool &tvalid_o, cdata_vec_
 
 }
 
+// ---------------------------------------------------------------------------------------------
+// dec2_ssr1: single-rate half-band decimator (decimation factor = 16, 32, 64, SSR = 1)
+// one input sample every valid input, one output every two valid inputs (skip toggles on every valid input,
+// so the gaps of the input do not change the decimation phase).
+// phase_reset_i marks an input sample that starts a decimation period: the sample is kept (output valid)
+// and the marker is forwarded with the output, to reset the phase of the next stage.
+// ---------------------------------------------------------------------------------------------
 template <int instance_id>
-void dec2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<1> &tdata_o)
+void dec2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool phase_reset_i, bool &tvalid_o, cdata_vec_t<1> &tdata_o, bool &phase_reset_o)
 {
 
 //#pragma HLS INLINE off
 
-    constexpr unsigned int num_coef = 31;
-    // prototype filter coefficients
-    const coef_int_t coeff_vec[num_coef] = {-197, 0, 501, 0, -1087, 0, 2079, 0, -3723, 0, 6596, 0, -12793, 0, 41339, 65536, 41339, 0, -12793, 0, 6596, 0, -3723, 0, 2079, 0, -1087, 0, 501, 0, -197};
-    // shift registers to align valid and beamid signal to the module output
+    constexpr unsigned int num_coef = hbf_num_taps;
+    // prototype filter coefficients (hbf_coefs.h)
+    coef_int_t coeff_vec[num_coef];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        coeff_vec[c] = hbf_coef[c];
+    }
+    // shift registers to align valid and phase reset signals to the module output
     static ap_shift_reg<bool, num_coef + 1> vld_shftreg;
+    static ap_shift_reg<bool, num_coef + 1> phase_shftreg;
 
     // ----------------------------------------------
     // control the shift register of the mac engine
@@ -421,8 +649,10 @@ void dec2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_
     static bool skip = false;
     // whether the filter memory is updated with the sample at its input, or it is maintained in the current state
     bool toshift_v = tvalid_i;
+    // the phase reset marker starts a new decimation period: the marked sample is kept
+    bool phase_reset_v = tvalid_i && phase_reset_i;
     // valid output
-    bool tvalid_v = (tvalid_i && !skip);
+    bool tvalid_v = tvalid_i && (phase_reset_v || !skip);
 
     if (tvalid_v)
     {
@@ -434,8 +664,9 @@ void dec2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_
         // the output was not valid (skipped), then next output will be valid
         skip = false;
     }
-    // align the valid signal to the output
+    // align the valid signal and the phase reset marker to the output
     tvalid_o = vld_shftreg.shift(tvalid_v, num_coef + 1 - 1);
+    phase_reset_o = phase_shftreg.shift(phase_reset_v, num_coef + 1 - 1);
 
     // input sample
     cdata_t tdata_vi;
@@ -450,6 +681,155 @@ void dec2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_
     tdata_o.im[0] = acc.im;
 }
 
+// ---------------------------------------------------------------------------------------------
+// dec2_ssr1_iq: single-rate half-band decimator with I/Q time-multiplexing (IQ_TDM, decimation factor = 32, 64)
+// The input of dec32 and dec64 is at most one sample every 2 and 4 clock cycles: each multiplier computes the I sample
+// in one clock cycle and the Q sample in the next one (multi_mac_systolic with 2 rails), which halves the multipliers
+// of dec2_ssr1. Same output and decimation phase as dec2_ssr1, one clock cycle later (the Q sample is computed after
+// the I sample).
+// A phase reset can keep two consecutive samples of the previous stage (the marked sample is always kept), then the
+// second one waits in a short queue: the latency grows by one clock cycle, and it is recovered on the idle input cycles.
+// The queue is not bounded by the design: without idle input cycles, every phase reset that changes the decimation
+// phase of the previous stage adds one clock cycle of latency. A sample that finds the queue full is dropped and sets
+// overflow_o (sticky until the design is reset, the filter has missed a sample).
+// ---------------------------------------------------------------------------------------------
+constexpr unsigned int iq_queue_depth = 4;
+
+template <int instance_id>
+void dec2_ssr1_iq(bool tvalid_i, cdata_vec_t<1> tdata_i, bool phase_reset_i, bool &tvalid_o, cdata_vec_t<1> &tdata_o, bool &phase_reset_o,
+                  bool &overflow_o)
+{
+
+//#pragma HLS INLINE off
+
+    constexpr unsigned int num_coef = hbf_num_taps;
+    // prototype filter coefficients (hbf_coefs.h)
+    coef_int_t coeff_vec[num_coef];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        coeff_vec[c] = hbf_coef[c];
+    }
+    // shift registers to align valid and phase reset signals to the module output (Q sample)
+    static ap_shift_reg<bool, num_coef + 1> vld_shftreg;
+    static ap_shift_reg<bool, num_coef + 1> phase_shftreg;
+
+    // ----------------------------------------------
+    // decimation phase (as dec2_ssr1)
+    // ----------------------------------------------
+    static bool skip = false;
+    // the phase reset marker starts a new decimation period: the marked sample is kept
+    bool phase_reset_v = tvalid_i && phase_reset_i;
+    // valid output
+    bool tvalid_v = tvalid_i && (phase_reset_v || !skip);
+
+    if (tvalid_v)
+    {
+        // when the output is valid, the next output will be discarded
+        skip = true;
+    }
+    else if (tvalid_i)
+    {
+        // the output was not valid (skipped), then next output will be valid
+        skip = false;
+    }
+
+    // input sample
+    cdata_t tdata_vi;
+    tdata_vi.re = tdata_i.re[0];
+    tdata_vi.im = tdata_i.im[0];
+
+    // ----------------------------------------------
+    // I/Q time-multiplexing
+    // ----------------------------------------------
+    // input samples waiting for the multipliers, with their valid output and phase reset flags
+    static cdata_t queue_data[iq_queue_depth];
+    static bool queue_vld[iq_queue_depth];
+    static bool queue_phase[iq_queue_depth];
+    static ap_uint<3> queue_count = 0;
+    static bool overflow = false;
+    // Q sample of the sample in the multipliers, computed in the next clock cycle
+    static bool im_slot = false;
+    static data_t im_r;
+    static bool vld_r;
+    static bool phase_r;
+
+    // whether the filter memory is updated with the sample at its input, or it is maintained in the current state
+    bool toshift_v = false;
+    data_t x_v = 0;
+    // valid output and phase reset marker of the sample at the input of the multipliers (set with the Q sample)
+    bool tvalid_s = false;
+    bool phase_reset_s = false;
+    // whether the input sample goes to the multipliers without waiting in the queue
+    bool bypass = false;
+
+    if (im_slot)
+    {
+        // Q sample
+        toshift_v = true;
+        x_v = im_r;
+        tvalid_s = vld_r;
+        phase_reset_s = phase_r;
+        im_slot = false;
+    }
+    else if (queue_count > 0)
+    {
+        // I sample of the oldest sample in the queue
+        toshift_v = true;
+        x_v = queue_data[0].re;
+        im_r = queue_data[0].im;
+        vld_r = queue_vld[0];
+        phase_r = queue_phase[0];
+        im_slot = true;
+        for (int q = 0; q < iq_queue_depth - 1; ++q)
+        {
+            queue_data[q] = queue_data[q + 1];
+            queue_vld[q] = queue_vld[q + 1];
+            queue_phase[q] = queue_phase[q + 1];
+        }
+        queue_count = queue_count - 1;
+    }
+    else if (tvalid_i)
+    {
+        // I sample of the input sample
+        toshift_v = true;
+        x_v = tdata_vi.re;
+        im_r = tdata_vi.im;
+        vld_r = tvalid_v;
+        phase_r = phase_reset_v;
+        im_slot = true;
+        bypass = true;
+    }
+
+    if (tvalid_i && !bypass)
+    {
+        if (queue_count < iq_queue_depth)
+        {
+            queue_data[queue_count] = tdata_vi;
+            queue_vld[queue_count] = tvalid_v;
+            queue_phase[queue_count] = phase_reset_v;
+            queue_count = queue_count + 1;
+        }
+        else
+        {
+            overflow = true;
+        }
+    }
+    overflow_o = overflow;
+
+    // align the valid signal and the phase reset marker to the output
+    tvalid_o = vld_shftreg.shift(tvalid_s, num_coef + 1 - 1);
+    phase_reset_o = phase_shftreg.shift(phase_reset_s, num_coef + 1 - 1);
+
+    // compute the output: the I sample is available one clock cycle before the Q sample
+    static acc_t acc_re_r;
+    acc_t acc = multi_mac_systolic<instance_id, num_coef, data_t, coef_t, acc_t, coef_int_t, 2>(toshift_v, x_v, coeff_vec);
+
+    // output sample - cast to the output data type
+    tdata_o.re[0] = acc_re_r;
+    tdata_o.im[0] = acc;
+    acc_re_r = acc;
+}
+
 // used for debugging
 template <int instance_id>
 void hbf(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<1> &tdata_o)
@@ -457,9 +837,13 @@ void hbf(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<1> &
 
 //#pragma HLS INLINE off
 
-    constexpr unsigned int num_coef = 31;
-    // prototype filter coefficients
-    const coef_int_t coeff_vec[num_coef] = {-197, 0, 501, 0, -1087, 0, 2079, 0, -3723, 0, 6596, 0, -12793, 0, 41339, 65536, 41339, 0, -12793, 0, 6596, 0, -3723, 0, 2079, 0, -1087, 0, 501, 0, -197};
+    constexpr unsigned int num_coef = hbf_num_taps;
+    // prototype filter coefficients (hbf_coefs.h)
+    coef_int_t coeff_vec[num_coef];
+    for (int c = 0; c < num_coef; ++c)
+    {
+        coeff_vec[c] = hbf_coef[c];
+    }
     // shift registers to align valid and beamid signal to the module output
     static ap_shift_reg<bool, num_coef + 1> vld_shftreg;
 
@@ -0,0 +1,167 @@
+/**
+ * @file delay_lines.h
+ * @brief delay lines with explicit mapping to FPGA storage resources
+ *
+ * @details
+ *  - delay_line<T, depth, policy>: delays the input by depth (enabled) clock cycles.
+ *    The policy selects the resource used to store the delay line:
+ *    - DL_REG:  registers (flip-flops), every element is accessible - use for short delay lines
+ *    - DL_SRL:  shift register LUTs (SRL16/SRL32), implemented by means of ap_shift_reg
+ *    - DL_BRAM: circular buffer in block RAM
+ *    - DL_URAM: circular buffer in ultra RAM
+ *    - DL_AUTO: the policy is selected from the depth of the delay line (see dl_resolve)
+ *
+ *  Only the output (oldest element) of a delay line is read, so the SRL and RAM policies are
+ *  suitable for the tap-to-tap delay of long or multi-channel (time-multiplexed) filters,
+ *  where every tap is separated by more than one clock cycle.
+ *
+ * @note
+ *  The storage pragmas cannot depend on a template argument, therefore each policy is implemented
+ *  by a specialization of delay_line_impl.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef DELAY_LINES_H_
+#define DELAY_LINES_H_
+
+#include "ap_int.h"
+
+// C++ class (ap_shift_reg) to ensure that the shift register defined in the C code is always implemented using an SRL resource
+#include "ap_shift_reg.h"
+
+// delay line storage policy
+enum dl_policy_t
+{
+    DL_REG = 0,
+    DL_SRL = 1,
+    DL_BRAM = 2,
+    DL_URAM = 3,
+    DL_AUTO = 4
+};
+
+// depth thresholds used by the DL_AUTO policy
+constexpr int dl_max_reg_depth = 2;   // up to 2 elements: registers (no gain in using a LUT)
+constexpr int dl_max_srl_depth = 128; // up to 4 cascaded SRL32: beyond use a block RAM
+
+/**
+ * @brief resolve the DL_AUTO policy based on the depth of the delay line
+ */
+constexpr int dl_resolve(int policy, int depth)
+{
+    return (policy != DL_AUTO) ? policy : (depth <= dl_max_reg_depth) ? DL_REG : (depth <= dl_max_srl_depth) ? DL_SRL : DL_BRAM;
+}
+
+/**
+ * @brief number of bits of the circular buffer pointer
+ */
+constexpr int dl_ptr_bits(int depth)
+{
+    return (depth <= 2) ? 1 : 1 + dl_ptr_bits((depth + 1) / 2);
+}
+
+template <typename T, int depth, int policy>
+class delay_line_impl;
+
+// registers
+template <typename T, int depth>
+class delay_line_impl<T, depth, DL_REG>
+{
+public:
+    T shift(T din, bool enable)
+    {
+#pragma HLS ARRAY_PARTITION variable = sreg complete
+        T dout = sreg[depth - 1];
+        if (enable)
+        {
+            for (int i = depth - 1; i > 0; i--)
+            {
+                sreg[i] = sreg[i - 1];
+            }
+            sreg[0] = din;
+        }
+        return dout;
+    }
+
+private:
+    T sreg[depth];
+};
+
+// shift register LUTs
+template <typename T, int depth>
+class delay_line_impl<T, depth, DL_SRL>
+{
+public:
+    T shift(T din, bool enable)
+    {
+        return sreg.shift(din, depth - 1, enable);
+    }
+
+private:
+    ap_shift_reg<T, depth> sreg;
+};
+
+// block RAM circular buffer
+template <typename T, int depth>
+class delay_line_impl<T, depth, DL_BRAM>
+{
+public:
+    T shift(T din, bool enable)
+    {
+#pragma HLS BIND_STORAGE variable = mem type = ram_s2p impl = bram
+#pragma HLS DEPENDENCE variable = mem inter false
+        // the oldest element is overwritten by the input
+        T dout = mem[ptr];
+        if (enable)
+        {
+            mem[ptr] = din;
+            ptr = (ptr == depth - 1) ? ptr_t(0) : ptr_t(ptr + 1);
+        }
+        return dout;
+    }
+
+private:
+    typedef ap_uint<dl_ptr_bits(depth)> ptr_t;
+    T mem[depth];
+    ptr_t ptr = 0;
+};
+
+// ultra RAM circular buffer
+template <typename T, int depth>
+class delay_line_impl<T, depth, DL_URAM>
+{
+public:
+    T shift(T din, bool enable)
+    {
+#pragma HLS BIND_STORAGE variable = mem type = ram_s2p impl = uram
+#pragma HLS DEPENDENCE variable = mem inter false
+        // the oldest element is overwritten by the input
+        T dout = mem[ptr];
+        if (enable)
+        {
+            mem[ptr] = din;
+            ptr = (ptr == depth - 1) ? ptr_t(0) : ptr_t(ptr + 1);
+        }
+        return dout;
+    }
+
+private:
+    typedef ap_uint<dl_ptr_bits(depth)> ptr_t;
+    T mem[depth];
+    ptr_t ptr = 0;
+};
+
+/**
+ * @brief delay line of depth enabled clock cycles
+ *
+ * shift() writes din (when enable is set) and returns the element written depth enabled cycles before.
+ */
+template <typename T, int depth, int policy = DL_AUTO>
+class delay_line : public delay_line_impl<T, depth, dl_resolve(policy, depth)>
+{
+};
+
+#endif /* DELAY_LINES_H_ */
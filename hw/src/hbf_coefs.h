@@ -0,0 +1,31 @@
+/**
+ * @file hbf_coefs.h
+ * @brief prototype half-band filter coefficients, one table per coefficient word length (COEF_BITS)
+ *
+ * @details
+ *  Generated by scripts/hbf_coef_bits.py - do not edit.
+ *  The coefficients are s<COEF_BITS>.<COEF_BITS - 1> integers (the center tap 0.5 is 2^(COEF_BITS - 2)),
+ *  constexpr so that the widths of the datapath can be derived from them (see ssr_multistage_decimator.h).
+ *  - 18 bits: MATLAB design (data/hbFilter.coe, matlab/dec_filter_design.m)
+ *  - 24, 27 bits: equiripple design of scripts/hbf_coef_bits.py (same specification)
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef HBF_COEFS_H_
+#define HBF_COEFS_H_
+
+constexpr int hbf_num_taps = 31;
+
+#if COEF_BITS == 18
+constexpr int hbf_coef[hbf_num_taps] = {-197, 0, 501, 0, -1087, 0, 2079, 0, -3723, 0, 6596, 0, -12793, 0, 41339, 65536, 41339, 0, -12793, 0, 6596, 0, -3723, 0, 2079, 0, -1087, 0, 501, 0, -197};
+#elif COEF_BITS == 24
+constexpr int hbf_coef[hbf_num_taps] = {-12661, 0, 32102, 0, -69571, 0, 133113, 0, -238327, 0, 422195, 0, -818769, 0, 2645679, 4194304, 2645679, 0, -818769, 0, 422195, 0, -238327, 0, 133113, 0, -69571, 0, 32102, 0, -12661};
+#elif COEF_BITS == 27
+constexpr int hbf_coef[hbf_num_taps] = {-101289, 0, 256820, 0, -556565, 0, 1064904, 0, -1906616, 0, 3377558, 0, -6550149, 0, 21165433, 33554432, 21165433, 0, -6550149, 0, 3377558, 0, -1906616, 0, 1064904, 0, -556565, 0, 256820, 0, -101289};
+#endif
+
+#endif /* HBF_COEFS_H_ */
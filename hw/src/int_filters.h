@@ -0,0 +1,294 @@
+/**
+ * @file int_filters.h
+ *
+ * @brief Interpolation (Half-band) filters implementing the SSR multi-stage interpolator (transmit path)
+ *
+ * - int2_ssr1<64>:  20 -> 40 (interpolation factor = 64, SSR = 1)
+ * - int2_ssr1<32>:  40 -> 80 (interpolation factor = 32, SSR = 1)
+ * - int2_ssr1<16>:  80 -> 160 (interpolation factor = 16, SSR = 1)
+ * - int2_ssr2:     160 -> 320 (interpolation factor = 8, SSR = 1 -> 2)
+ * - int2_ssr4:     320 -> 640 (interpolation factor = 4, SSR = 2 -> 4)
+ * - int2_ssr8:     640 -> 1280 (interpolation factor = 2, SSR = 4 -> 8)
+ *
+ *  Same prototype filter as the decimator (hbf_coefs.h). Each stage is the SSR filter of the zero-stuffed input:
+ *  with N input lanes the zero-stuffed word has 2 N lanes, the odd lanes are zero, so only the even lanes drive the
+ *  polyphase branches (the multiplications by the stuffed zeros are not computed), and the half-band zeros of the
+ *  prototype are constant coefficients removed by the tool. The zero stuffing halves the gain: the filter output
+ *  is multiplied by 2 (int2_gain) and saturated to the data type.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef INT_FILTERS_H_
+#define INT_FILTERS_H_
+
+#include "ssr_multistage_decimator.h"
+#include "mac_engines.h"
+#include "hbf_coefs.h"
+
+// the instance ids of the engines of the interpolator start from int_instance_base (separate state from the decimator)
+constexpr int int_instance_base = 100;
+
+// ---------------------------------------------------------------------------------------------
+// polyphase branches of an interpolation stage with N input lanes (2 N output lanes):
+// the zero-stuffed input word is U_2j = X_j, U_2j+1 = 0, and (as in the decimator stages, M = 2 N)
+// Y_r = sum_j P_((r - 2 j) mod 2N) X_j, with one word delay (z^-2N) for 2 j > r, P_k(c) = h(2 N c + k)
+// lane_coef[j][r][c] = P_((r - 2 j) mod 2N)(c): coefficients of the branches of the output r driven by the input lane j
+// ---------------------------------------------------------------------------------------------
+template <int N, int num_coef>
+void int2_lane_coefs(coef_int_t lane_coef[N][2 * N][num_coef])
+{
+#pragma HLS INLINE
+    for (int j = 0; j < N; ++j)
+    {
+        for (int r = 0; r < 2 * N; ++r)
+        {
+            for (int c = 0; c < num_coef; ++c)
+            {
+                int k = 2 * N * c + ((r - 2 * j) & (2 * N - 1));
+                lane_coef[j][r][c] = (k < hbf_num_taps) ? hbf_coef[k] : 0;
+            }
+        }
+    }
+}
+
+// stage output: the filter output times 2 (binary point moved by one bit), saturated to the data type
+data_t int2_gain(acc_t acc)
+{
+#pragma HLS INLINE
+    int_acc_t y;
+    y.range() = acc.range();
+    return data_sat_t(y);
+}
+
+// ---------------------------------------------------------------------------------------------
+// int2_ssr8: 640 -> 1280 (overall interpolation factor = 2, SSR = 4 -> 8)
+// 4 inputs per clock cycle, 8 outputs per clock cycle (omitting the term z^8 for clarity)
+// * Y0 = P0 X0 + (z^-8){P6 X1 + P4 X2 + P2 X3},  Y1 = P1 X0 + (z^-8){P7 X1 + P5 X2 + P3 X3}
+// * Y2 = P2 X0 + P0 X1 + (z^-8){P6 X2 + P4 X3},  Y3 = P3 X0 + P1 X1 + (z^-8){P7 X2 + P5 X3}
+// * Y4 = P4 X0 + P2 X1 + P0 X2 + (z^-8)P6 X3,    Y5 = P5 X0 + P3 X1 + P1 X2 + (z^-8)P7 X3
+// * Y6 = P6 X0 + P4 X1 + P2 X2 + P0 X3,          Y7 = P7 X0 + P5 X1 + P3 X2 + P1 X3
+// (18 bits: P1 = P3 = P5 = 0, P7 = {0, 65536, 0, 0})
+// ---------------------------------------------------------------------------------------------
+void int2_ssr8(bool tvalid_i, cdata_vec_t<4> tdata_i, bool &tvalid_o, cdata_vec_t<8> &tdata_o)
+{
+    constexpr unsigned int num_coef = 4;
+    coef_int_t lane_coef[4][8][num_coef];
+    int2_lane_coefs<4, num_coef>(lane_coef);
+
+    constexpr unsigned int latency_phase_combiner = 1;
+    constexpr unsigned int latency = num_coef + latency_phase_combiner;
+
+    // shift register to align the valid signal to the module output
+    static ap_shift_reg<bool, latency> vld_shftreg;
+    // the delay line only moves on valid inputs
+    bool toshift_v = tvalid_i;
+    tvalid_o = vld_shftreg.shift(tvalid_i, latency - 1);
+
+    cdata_t tdata_vi[4];
+    for (int j = 0; j < 4; ++j)
+#pragma HLS UNROLL
+    {
+        tdata_vi[j].re = tdata_i.re[j];
+        tdata_vi[j].im = tdata_i.im[j];
+    }
+
+    // not possible to create a loop because template instantiation
+    cacc_t lane_acc[4][8];
+    multi_mac_systolic_shared<int_instance_base + 0, num_coef, 8>(toshift_v, tdata_vi[0], lane_coef[0], lane_acc[0]); // X0(z^4)
+    multi_mac_systolic_shared<int_instance_base + 1, num_coef, 8>(toshift_v, tdata_vi[1], lane_coef[1], lane_acc[1]); // X1(z^4)
+    multi_mac_systolic_shared<int_instance_base + 2, num_coef, 8>(toshift_v, tdata_vi[2], lane_coef[2], lane_acc[2]); // X2(z^4)
+    multi_mac_systolic_shared<int_instance_base + 3, num_coef, 8>(toshift_v, tdata_vi[3], lane_coef[3], lane_acc[3]); // X3(z^4)
+
+    // regroup the branch outputs per output: acc_ph[r][j] = P_((r - 2 j) mod 8) X_j
+    cacc_t acc_ph[8][4];
+    for (int r = 0; r < 8; ++r)
+#pragma HLS UNROLL
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            acc_ph[r][j] = lane_acc[j][r];
+        }
+    }
+
+    cacc_t acc[8];
+    acc[0] = phase_combiner<int_instance_base + 0, 4, 1, 3>(acc_ph[0]);
+    acc[1] = phase_combiner<int_instance_base + 1, 4, 1, 3>(acc_ph[1]);
+    acc[2] = phase_combiner<int_instance_base + 2, 4, 2, 2>(acc_ph[2]);
+    acc[3] = phase_combiner<int_instance_base + 3, 4, 2, 2>(acc_ph[3]);
+    acc[4] = phase_combiner<int_instance_base + 4, 4, 3, 1>(acc_ph[4]);
+    acc[5] = phase_combiner<int_instance_base + 5, 4, 3, 1>(acc_ph[5]);
+    acc[6] = phase_combiner<int_instance_base + 6, 4, 4, 0>(acc_ph[6]);
+    acc[7] = phase_combiner<int_instance_base + 7, 4, 4, 0>(acc_ph[7]);
+
+    for (int r = 0; r < 8; ++r)
+#pragma HLS UNROLL
+    {
+        tdata_o.re[r] = int2_gain(acc[r].re);
+        tdata_o.im[r] = int2_gain(acc[r].im);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// int2_ssr4: 320 -> 640 (overall interpolation factor = 4, SSR = 2 -> 4)
+// 2 inputs per clock cycle, 4 outputs per clock cycle (omitting the term z^4 for clarity)
+// * Y0 = P0 X0 + (z^-4)P2 X1,  Y1 = P1 X0 + (z^-4)P3 X1
+// * Y2 = P2 X0 + P0 X1,        Y3 = P3 X0 + P1 X1
+// (18 bits: P1 = 0, P3 = {0, 0, 0, 65536, 0, 0, 0, 0})
+// ---------------------------------------------------------------------------------------------
+void int2_ssr4(bool tvalid_i, cdata_vec_t<2> tdata_i, bool &tvalid_o, cdata_vec_t<4> &tdata_o)
+{
+    constexpr unsigned int num_coef = 8;
+    coef_int_t lane_coef[2][4][num_coef];
+    int2_lane_coefs<2, num_coef>(lane_coef);
+
+    constexpr unsigned int latency_phase_combiner = 1;
+    constexpr unsigned int latency = num_coef + latency_phase_combiner;
+
+    // shift register to align the valid signal to the module output
+    static ap_shift_reg<bool, latency> vld_shftreg;
+    // the delay line only moves on valid inputs
+    bool toshift_v = tvalid_i;
+    tvalid_o = vld_shftreg.shift(tvalid_i, latency - 1);
+
+    cdata_t tdata_vi[2];
+    for (int j = 0; j < 2; ++j)
+#pragma HLS UNROLL
+    {
+        tdata_vi[j].re = tdata_i.re[j];
+        tdata_vi[j].im = tdata_i.im[j];
+    }
+
+    // not possible to create a loop because template instantiation
+    cacc_t lane_acc[2][4];
+    multi_mac_systolic_shared<int_instance_base + 10, num_coef, 4>(toshift_v, tdata_vi[0], lane_coef[0], lane_acc[0]); // X0(z^2)
+    multi_mac_systolic_shared<int_instance_base + 11, num_coef, 4>(toshift_v, tdata_vi[1], lane_coef[1], lane_acc[1]); // X1(z^2)
+
+    // regroup the branch outputs per output: acc_ph[r][j] = P_((r - 2 j) mod 4) X_j
+    cacc_t acc_ph[4][2];
+    for (int r = 0; r < 4; ++r)
+#pragma HLS UNROLL
+    {
+        for (int j = 0; j < 2; ++j)
+        {
+            acc_ph[r][j] = lane_acc[j][r];
+        }
+    }
+
+    cacc_t acc[4];
+    acc[0] = phase_combiner<int_instance_base + 10, 2, 1, 1>(acc_ph[0]);
+    acc[1] = phase_combiner<int_instance_base + 11, 2, 1, 1>(acc_ph[1]);
+    acc[2] = phase_combiner<int_instance_base + 12, 2, 2, 0>(acc_ph[2]);
+    acc[3] = phase_combiner<int_instance_base + 13, 2, 2, 0>(acc_ph[3]);
+
+    for (int r = 0; r < 4; ++r)
+#pragma HLS UNROLL
+    {
+        tdata_o.re[r] = int2_gain(acc[r].re);
+        tdata_o.im[r] = int2_gain(acc[r].im);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// int2: half-band interpolator with one input lane and two output lanes (SSR = 1 -> 2)
+// * Y0 = P0 X0,  Y1 = P1 X0  (P0(c) = h(2 c), P1(c) = h(2 c + 1), 18 bits: P1 = {0, ..., 0, 65536, 0, ..., 0})
+// the two branches share the tapped delay line of the input
+// ---------------------------------------------------------------------------------------------
+template <int instance_id>
+void int2(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<2> &tdata_o)
+{
+    constexpr unsigned int num_coef = 16;
+    coef_int_t lane_coef[1][2][num_coef];
+    int2_lane_coefs<1, num_coef>(lane_coef);
+
+    constexpr unsigned int latency_phase_combiner = 1;
+    constexpr unsigned int latency = num_coef + latency_phase_combiner;
+
+    // shift register to align the valid signal to the module output
+    static ap_shift_reg<bool, latency> vld_shftreg;
+    // the delay line only moves on valid inputs
+    bool toshift_v = tvalid_i;
+    tvalid_o = vld_shftreg.shift(tvalid_i, latency - 1);
+
+    cdata_t tdata_vi;
+    tdata_vi.re = tdata_i.re[0];
+    tdata_vi.im = tdata_i.im[0];
+
+    cacc_t lane_acc[2];
+    multi_mac_systolic_shared<instance_id, num_coef, 2>(toshift_v, tdata_vi, lane_coef[0], lane_acc);
+
+    cacc_t acc[2];
+    acc[0] = phase_combiner<instance_id, 1, 1, 0>(&lane_acc[0]);
+    acc[1] = phase_combiner<instance_id + 1, 1, 1, 0>(&lane_acc[1]);
+
+    for (int r = 0; r < 2; ++r)
+#pragma HLS UNROLL
+    {
+        tdata_o.re[r] = int2_gain(acc[r].re);
+        tdata_o.im[r] = int2_gain(acc[r].im);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// int2_ssr2: 160 -> 320 (overall interpolation factor = 8, SSR = 1 -> 2), one input sample per clock cycle
+// ---------------------------------------------------------------------------------------------
+void int2_ssr2(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<2> &tdata_o)
+{
+    int2<int_instance_base + 20>(tvalid_i, tdata_i, tvalid_o, tdata_o);
+}
+
+// ---------------------------------------------------------------------------------------------
+// int2_ssr1: single-rate half-band interpolator (interpolation factor = 16, 32, 64, SSR = 1)
+// The input of the stage of interpolation factor L is one sample every L / 8 clock cycles (the input schedule of
+// ssr_multistage_interpolator): the two output samples of an input sample leave L / 16 clock cycles apart, so the
+// output is one sample every L / 16 clock cycles, the input rate of the next stage.
+// ---------------------------------------------------------------------------------------------
+template <int instance_id>
+void int2_ssr1(bool tvalid_i, cdata_vec_t<1> tdata_i, bool &tvalid_o, cdata_vec_t<1> &tdata_o)
+{
+    constexpr int half_period = instance_id / 16;
+    static_assert(half_period >= 1 && half_period <= 4, "int2_ssr1 is the stage of interpolation factor 16, 32 or 64");
+
+    bool tvalid_v;
+    cdata_vec_t<2> tdata_v;
+    int2<int_instance_base + instance_id>(tvalid_i, tdata_i, tvalid_v, tdata_v);
+
+    // odd output sample, sent half_period clock cycles after the even one
+    static data_t odd_re = 0;
+    static data_t odd_im = 0;
+    static bool odd_pending = false;
+    static ap_uint<3> odd_wait = 0;
+
+    if (tvalid_v)
+    {
+        tvalid_o = true;
+        tdata_o.re[0] = tdata_v.re[0];
+        tdata_o.im[0] = tdata_v.im[0];
+        odd_re = tdata_v.re[1];
+        odd_im = tdata_v.im[1];
+        odd_pending = true;
+        odd_wait = half_period - 1;
+    }
+    else if (odd_pending && odd_wait == 0)
+    {
+        tvalid_o = true;
+        tdata_o.re[0] = odd_re;
+        tdata_o.im[0] = odd_im;
+        odd_pending = false;
+    }
+    else
+    {
+        tvalid_o = false;
+        tdata_o.re[0] = odd_re;
+        tdata_o.im[0] = odd_im;
+        if (odd_pending)
+        {
+            odd_wait = odd_wait - 1;
+        }
+    }
+}
+
+#endif /* INT_FILTERS_H_ */
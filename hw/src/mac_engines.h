@@ -11,6 +11,17 @@
  *               consider using the systolic architecture for better performance
  * 
  * - multi_mac_systolic: systolic implementation of the Direct Form Type 1 Tapped Delay Line FIR filter architecture,
+ *               templated on the data, coefficient and accumulator types (the defaults are the types of the stages,
+ *               the fast FIR algorithm sub-filters use the wider types of the FFA pre-additions, see dec_filters.h, SSR_FFA),
+ *               and on the number of time-multiplexed rails (num_rails = 2: one multiplier per tap computes the I and
+ *               the Q samples on two consecutive clock cycles, see dec_filters.h, IQ_TDM)
+ *
+ * - multi_mac_systolic_shared: systolic MAC engine with one tapped delay line shared by several polyphase branches,
+ *               each tap of the delay line fans out to one multiplier/accumulator chain per branch
+ *
+ * - multi_mac_systolic_tdm_bank: systolic MAC engine for num_channels time-multiplexed channels, each channel with its
+ *               own coefficients (e.g. the polyphase branches of a filter bank, see pfb_channelizer.h),
+ *               the tap-to-tap delay lines are mapped to registers, SRL, BRAM or URAM according to a policy (see delay_lines.h)
  *
  * - mac_single_tap: a single multiplier, used in the polyphase decomposition of the Half-Band filters
  *
@@ -32,6 +43,7 @@
 #define MAC_ENGINES_H_
 
 #include "ssr_multistage_decimator.h"
+#include "delay_lines.h"
 
 template <int instance_id, int num_coef>
 cacc_t multi_mac(bool toshift_i, cdata_t x_i, coef_t h[num_coef])
@@ -61,26 +73,68 @@ MULTMACLOOP:
     return acc;
 }
 
-template <int instance_id, int num_coef>
-cacc_t multi_mac_systolic(bool toshift_i, cdata_t x_i, const coef_int_t coef_vec[num_coef])
+// product and sum of the systolic MAC engines: both rails of the complex types, or a real sample (I/Q time-multiplexing)
+template <typename T_acc, typename T_data, typename T_coef>
+void mac_mult(T_acc &y, const T_data &x, const T_coef &h)
+{
+    y.re = x.re * h;
+    y.im = x.im * h;
+}
+
+inline void mac_mult(acc_t &y, const data_t &x, const coef_t &h)
+{
+    y = x * h;
+}
+
+template <typename T_acc>
+void mac_add(T_acc &y, const T_acc &a, const T_acc &b)
+{
+    y.re = a.re + b.re;
+    y.im = a.im + b.im;
+}
+
+inline void mac_add(acc_t &y, const acc_t &a, const acc_t &b)
+{
+    y = a + b;
+}
+
+/**
+ * @brief systolic MAC engine
+ *
+ * The types default to the data, coefficient and accumulator types of the stages. The sub-filters of the fast FIR
+ * algorithm (FFA) use the same engine with the wider types of the FFA pre-additions: the input is a sum of input lanes
+ * (cffa_data_t), the coefficients are sums of polyphase components (ffa_coef_t, ffa_coef_int_t) and the accumulator is
+ * wide enough for the sub-filter output (cffa_acc_t), so the FFA is bit-exact with the direct form.
+ *
+ * With num_rails = 2 (I/Q time-multiplexing, real data_t and acc_t types), the input carries the I and the Q samples of
+ * a complex sample on two consecutive enabled cycles, so every tap needs one multiplier instead of one per rail.
+ * The shift register of each tap holds the last sample of every rail (num_rails + 1 clocks per tap with the input
+ * register of the DSP slice, see multi_mac_systolic_tdm_bank). The accumulator chain is free running and the enable
+ * travels along the taps with the accumulator, so the output does not depend on the pattern of the enabled cycles:
+ * the output of the sample enabled at clock t is available at clock t + num_coef + 1 for any num_rails.
+ *
+ * @param toshift_i  update the tapped delay line with x_i
+ * @param x_i        input sample
+ * @param coef_vec   filter coefficients
+ */
+template <int instance_id, int num_coef, typename T_data = cdata_t, typename T_coef = coef_t, typename T_acc = cacc_t,
+          typename T_coef_int = coef_int_t, int num_rails = 1>
+T_acc multi_mac_systolic(bool toshift_i, T_data x_i, const T_coef_int coef_vec[num_coef])
 {
 
 //#pragma HLS INLINE off
 
-    // shift register for input data
-    static cdata_t data_sreg[num_coef];
+    // shift register for input data: the last sample of every rail (data_sreg[0][r > 0] is not used)
+    static T_data data_sreg[num_coef][num_rails];
     
     // DSP48E1 signals
-    static cdata_t x_r[num_coef];
-    coef_t h;
-    cacc_t mult;
-    static cacc_t acc_r[num_coef];
+    static T_data x_r[num_coef];
+    T_coef h;
+    T_acc mult;
+    static T_acc acc_r[num_coef];
     
     // control the tapped delay line
     static bool toshift_r[num_coef];
-    
-    // mux to select input to the data shift register
-    cdata_t x_mux;
 
 // loop for all the taps
 MULTMACLOOP:
@@ -89,11 +143,92 @@ MULTMACLOOP:
     {
         h.range() = coef_vec[i];
         // multiplier with registered output
-        mult.re = x_r[i].re * h;
-        mult.im = x_r[i].im * h;
+        mac_mult(mult, x_r[i], h);
         // one clock delay for the accumulator
-        acc_r[i].re = acc_r[i - 1].re + mult.re;
-        acc_r[i].im = acc_r[i - 1].im + mult.im;
+        mac_add(acc_r[i], acc_r[i - 1], mult);
+
+        // read the sample of the same rail from the shift register
+        x_r[i] = data_sreg[i][num_rails - 1];
+
+        // shift the shift register when the enable reaches the tap (otherwise it keeps its data)
+        if (toshift_r[i - 1])
+        {
+            for (int r = num_rails - 1; r >= 1; r--)
+            {
+                data_sreg[i][r] = data_sreg[i][r - 1];
+            }
+            data_sreg[i][0] = x_r[i - 1];
+        }
+
+        toshift_r[i] = toshift_r[i - 1];
+    }
+
+    // multiply the first tap
+    h.range() = coef_vec[0];
+    mac_mult(acc_r[0], x_r[0], h);
+
+    x_r[0] = data_sreg[0][0];
+
+    toshift_r[0] = toshift_i;
+
+    // update the shift register only when the input is valid
+    if (toshift_i)
+    {
+        data_sreg[0][0] = x_i;
+    }
+    
+    return (acc_r[num_coef - 1]);
+}
+
+/**
+ * @brief systolic MAC engine with a tapped delay line shared by num_phases polyphase branches
+ *
+ * In the SSR filters each input lane X_j is filtered by several polyphase components P_k (one per computed output).
+ * Instead of instantiating one multi_mac_systolic per (lane, output) pair, each keeping its own copy of the same
+ * input history, the lane history is stored once (data_sreg, x_r, toshift_r) and every tap feeds num_phases
+ * multipliers, one per branch. Each branch keeps its own accumulator chain, so the result is bit-exact with
+ * num_phases independent multi_mac_systolic instances driven by the same input.
+ *
+ * @param toshift_i  update the tapped delay line with x_i
+ * @param x_i        input sample of the lane
+ * @param coef_mat   coefficients of each branch
+ * @param acc_o      output of each branch
+ */
+template <int instance_id, int num_coef, int num_phases>
+void multi_mac_systolic_shared(bool toshift_i, cdata_t x_i, const coef_int_t coef_mat[num_phases][num_coef], cacc_t acc_o[num_phases])
+{
+
+    // shift register for input data - shared by all the branches
+    static cdata_t data_sreg[num_coef];
+
+    // DSP48E1 signals
+    static cdata_t x_r[num_coef];
+    coef_t h;
+    cacc_t mult;
+    static cacc_t acc_r[num_phases][num_coef];
+
+    // control the tapped delay line
+    static bool toshift_r[num_coef];
+
+    // mux to select input to the data shift register
+    cdata_t x_mux;
+
+// loop for all the taps
+MULTMACSHAREDLOOP:
+    // all the MAC run in parallel
+    for (int i = num_coef - 1; i >= 1; i--)
+    {
+        // the same tap drives the multiplier of each branch
+        for (int p = 0; p < num_phases; p++)
+        {
+            h.range() = coef_mat[p][i];
+            // multiplier with registered output
+            mult.re = x_r[i].re * h;
+            mult.im = x_r[i].im * h;
+            // one clock delay for the accumulator
+            acc_r[p][i].re = acc_r[p][i - 1].re + mult.re;
+            acc_r[p][i].im = acc_r[p][i - 1].im + mult.im;
+        }
 
         // read data from the shift register
         x_r[i] = data_sreg[i];
@@ -102,15 +237,18 @@ MULTMACLOOP:
         x_mux = toshift_r[i - 1] ? x_r[i - 1] : x_r[i];
 
         // shift all values up one and load x_mux into location 0
-        data_sreg[i] = x_mux; // toshift_i ? x_r[i - 1] : data_sreg[i];
+        data_sreg[i] = x_mux;
 
         toshift_r[i] = toshift_r[i - 1];
     }
 
     // multiply the first tap
-    h.range() = coef_vec[0];
-    acc_r[0].re = x_r[0].re * h;
-    acc_r[0].im = x_r[0].im * h;
+    for (int p = 0; p < num_phases; p++)
+    {
+        h.range() = coef_mat[p][0];
+        acc_r[p][0].re = x_r[0].re * h;
+        acc_r[p][0].im = x_r[0].im * h;
+    }
 
     x_r[0] = data_sreg[0];
 
@@ -120,7 +258,76 @@ MULTMACLOOP:
 
     // update the shift register only when the input is valid
     data_sreg[0] = x_mux;
-    
+
+    for (int p = 0; p < num_phases; p++)
+    {
+        acc_o[p] = acc_r[p][num_coef - 1];
+    }
+}
+
+/**
+ * @brief systolic MAC engine for num_channels time-multiplexed channels, each channel with its own coefficients
+ *
+ * The input carries one sample per enabled clock cycle, the channels interleaved (ch0, ch1, ..., ch(N-1), ch0, ...).
+ * In the systolic chain the accumulator is delayed by one clock per tap, therefore the data must be delayed by
+ * num_channels + 1 clocks per tap to meet the sample of the same channel: the tap-to-tap delay line (num_channels deep)
+ * is stored according to dl_policy, the extra register is the input register of the DSP slice. The whole engine
+ * (delay lines and accumulator chain) is clock-enabled by toshift_i, so the output of each channel does not depend on
+ * the pattern of the enabled cycles.
+ *
+ * Channel c is filtered by coef_bank[c]. ch_i is the channel of the input sample (ch_i increments by one modulo
+ * num_channels at every enabled cycle).
+ * The sample at tap i entered the engine i + 1 enabled cycles earlier, so the coefficient of tap i is selected by the
+ * channel (ch_i - 1 - i) mod num_channels. The output at the enabled cycle t is the output of the channel sampled at
+ * the enabled cycle t - num_coef.
+ *
+ * @param toshift_i  clock enable (valid input)
+ * @param ch_i       channel of the input sample
+ * @param x_i        input sample
+ * @param coef_bank  filter coefficients of each channel
+ */
+template <int instance_id, int num_coef, int num_channels, int dl_policy = DL_AUTO>
+cacc_t multi_mac_systolic_tdm_bank(bool toshift_i, ap_uint<8> ch_i, cdata_t x_i, const coef_int_t coef_bank[num_channels][num_coef])
+{
+    static_assert((num_channels & (num_channels - 1)) == 0, "the number of channels must be a power of 2");
+
+    // tap-to-tap delay lines (data_dl[0] is not used)
+    static delay_line<cdata_t, num_channels, dl_policy> data_dl[num_coef];
+
+    // DSP48E1 signals
+    static cdata_t x_r[num_coef];
+    coef_t h;
+    cacc_t mult;
+    static cacc_t acc_r[num_coef];
+
+    if (toshift_i)
+    {
+    // loop for all the taps
+    MULTMACBANKLOOP:
+        // all the MAC run in parallel
+        for (int i = num_coef - 1; i >= 1; i--)
+        {
+            // coefficient of the channel at the tap
+            h.range() = coef_bank[(ch_i - 1 - i) & (num_channels - 1)][i];
+            // multiplier with registered output
+            mult.re = x_r[i].re * h;
+            mult.im = x_r[i].im * h;
+            // one clock delay for the accumulator
+            acc_r[i].re = acc_r[i - 1].re + mult.re;
+            acc_r[i].im = acc_r[i - 1].im + mult.im;
+
+            // sample of the same channel, one sample earlier
+            x_r[i] = data_dl[i].shift(x_r[i - 1], true);
+        }
+
+        // multiply the first tap
+        h.range() = coef_bank[(ch_i - 1) & (num_channels - 1)][0];
+        acc_r[0].re = x_r[0].re * h;
+        acc_r[0].im = x_r[0].im * h;
+
+        x_r[0] = x_i;
+    }
+
     return (acc_r[num_coef - 1]);
 }
 
@@ -173,4 +380,49 @@ cacc_t phase_combiner(cacc_t ph[N])
     return acc;
 }
 
+// pre/post-additions of the FFA structure
+inline cffa_data_t ffa_add(cffa_data_t a, cffa_data_t b)
+{
+    cffa_data_t y;
+    y.re = a.re + b.re;
+    y.im = a.im + b.im;
+    return y;
+}
+
+inline cffa_acc_t ffa_add(cffa_acc_t a, cffa_acc_t b)
+{
+    cffa_acc_t y;
+    y.re = a.re + b.re;
+    y.im = a.im + b.im;
+    return y;
+}
+
+inline cffa_acc_t ffa_sub(cffa_acc_t a, cffa_acc_t b)
+{
+    cffa_acc_t y;
+    y.re = a.re - b.re;
+    y.im = a.im - b.im;
+    return y;
+}
+
+/**
+ * @brief FFA output combiner: ph0 + z^-1 ph1 (one clock cycle = one block of SSR samples, as in phase_combiner)
+ *
+ * The sub-filter outputs are held during the gaps of the input, so the one clock delay is one valid input word.
+ */
+template <int instance_id>
+cacc_t ffa_combiner(cffa_acc_t ph0, cffa_acc_t ph1)
+{
+    static cffa_acc_t ph1_r;
+
+    // the stage output fits the accumulator of the direct form (see acc_t)
+    cacc_t acc;
+    acc.re = ph0.re + ph1_r.re;
+    acc.im = ph0.im + ph1_r.im;
+
+    ph1_r = ph1;
+
+    return acc;
+}
+
 #endif /* MAC_ENGINES_H_ */
\ No newline at end of file
@@ -0,0 +1,325 @@
+/**
+ * @file pfb_channelizer.h
+ * @brief polyphase filter bank (PFB) channelizer: splits the input band into pfb_channels uniform channels
+ *
+ * @details
+ *  Critically sampled analysis filter bank of M = pfb_channels channels: channel k is centred at k fs / M
+ *  (k >= M / 2 are the negative frequencies (k - M) fs / M), its output is the input shifted by -k fs / M, filtered by
+ *  the prototype low-pass filter h (pfb_coefs.h, cut-off fs / (2 M)) and decimated by M.
+ *
+ *  - polyphase branches: block m holds the input samples x(m M + p), p = 0, ..., M - 1 (M / 8 input words).
+ *    Branch p filters the samples p of the blocks with the coefficients g_p(r) = h(r M + M - 1 - p).
+ *    Lane j of the input word w carries the sample p = 8 w + j, so the M / 8 branches of a lane are time-multiplexed
+ *    on one MAC engine (multi_mac_systolic_tdm_bank): 8 engines of pfb_taps_per_branch taps for any M.
+ *  - SSR FFT: channel k of block m is sum_p v_p W_M^(k p), W_M = exp(-j 2 pi / M) (v_p: branch outputs).
+ *    With k = q + k1 M / 8 and p = j + 8 w, it is computed one output word q per clock cycle (decomposition M = 8 x M / 8):
+ *    M / 8-point DFT across the words of each lane (bin q, no multipliers: the twiddles are +/-1, +/-j),
+ *    twiddle W_M^(j q) on each lane, then 8-point FFT across the lanes (bin k1 on lane k1).
+ *    The output word q carries the channels q, q + M / 8, ..., q + 7 M / 8 on lanes 0 to 7.
+ *
+ *  The filter bank advances on the valid input words, and every valid input word gives one output word
+ *  (8 channel samples per clock cycle, the input rate). The marked word (sync) starts a block: the output word
+ *  of a block with the same index (see sample_counter) is channel block m, word q for all the channelizers
+ *  synchronized by the same phase reset.
+ *
+ *  Fixed point: the coefficients are scaled by M / 2 (s18.17, largest coefficient about 0.5), the branch outputs
+ *  accumulate in acc_t and the FFT computes in pfb_data_t, whose integer bits hold the largest output
+ *  (sum |h| x M / 2, derived from the coefficients). The FFT output is divided by M / 2 and rounded and saturated
+ *  to dataout_t.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef PFB_CHANNELIZER_H_
+#define PFB_CHANNELIZER_H_
+
+#include "ssr_multistage_decimator.h"
+#include "mac_engines.h"
+#include "pfb_coefs.h"
+
+// input words per block and valid words from the first word of a block to its first output word
+constexpr int pfb_words = pfb_channels / ssr;
+constexpr int pfb_latency = pfb_taps_per_branch + pfb_words;
+// the engine output at the word w of a block is the branch of the word w (of an earlier block)
+static_assert(pfb_taps_per_branch % pfb_words == 0, "the taps per branch must be a multiple of the words per block");
+// division of the FFT output by M / 2
+constexpr int pfb_scale_shift = (pfb_channels == 32) ? 4 : 3;
+
+// largest sum of the absolute values of the coefficients of a branch (branch output in units of the coefficient lsb)
+constexpr long long pfb_branch_abs_sum_max()
+{
+    long long max = 0;
+    for (int p = 0; p < pfb_channels; ++p)
+    {
+        long long sum = 0;
+        for (int r = 0; r < pfb_taps_per_branch; ++r)
+        {
+            int c = pfb_coef[r * pfb_channels + p];
+            sum += (c < 0) ? -c : c;
+        }
+        max = (sum > max) ? sum : max;
+    }
+    return max;
+}
+static_assert(signed_integer_bits(pfb_branch_abs_sum_max(), coef_fractional_bits) <= acc_integer_bits, "the branch outputs must fit acc_t");
+
+// FFT data: the integer bits hold sum |h| x M / 2 (bound of every partial sum of the FFT), the fractional bits the
+// output lsb after the division by M / 2, plus guard bits
+constexpr int pfb_fft_integer_bits = signed_integer_bits(coef_abs_sum(pfb_coef, pfb_num_taps), coef_fractional_bits);
+constexpr int pfb_fft_fractional_bits = data_fractional_bits + 6;
+typedef ap_fixed<pfb_fft_integer_bits + pfb_fft_fractional_bits, pfb_fft_integer_bits> pfb_data_t;                     // s26.21 (s27.21 for 32 channels)
+typedef ap_fixed<pfb_fft_integer_bits + pfb_fft_fractional_bits, pfb_fft_integer_bits - pfb_scale_shift> pfb_scaled_t; // FFT output / (M / 2)
+typedef ap_fixed<18, 2> pfb_twiddle_t;                                                                                  // s18.16
+typedef ap_uint<8> pfb_word_t;
+
+typedef struct
+{
+    pfb_data_t re;
+    pfb_data_t im;
+} cpfb_t;
+
+// complex addition and subtraction
+cpfb_t pfb_add(cpfb_t a, cpfb_t b)
+{
+#pragma HLS INLINE
+    cpfb_t y;
+    y.re = a.re + b.re;
+    y.im = a.im + b.im;
+    return y;
+}
+
+cpfb_t pfb_sub(cpfb_t a, cpfb_t b)
+{
+#pragma HLS INLINE
+    cpfb_t y;
+    y.re = a.re - b.re;
+    y.im = a.im - b.im;
+    return y;
+}
+
+// multiplication by (-j)^e: a swap of I/Q and sign changes, no multiplier
+cpfb_t pfb_rotate(cpfb_t x, int e)
+{
+#pragma HLS INLINE
+    cpfb_t y;
+    switch (e & 3)
+    {
+    case 1:
+        y.re = x.im;
+        y.im = -x.re;
+        break;
+    case 2:
+        y.re = -x.re;
+        y.im = -x.im;
+        break;
+    case 3:
+        y.re = -x.im;
+        y.im = x.re;
+        break;
+    default:
+        y = x;
+        break;
+    }
+    return y;
+}
+
+// multiplication by W_8^e = exp(-j 2 pi e / 8), e = 0, ..., 3
+cpfb_t pfb_w8(cpfb_t x, int e)
+{
+#pragma HLS INLINE
+    const pfb_twiddle_t rsqrt2 = 0.70710678118654752;
+    cpfb_t y;
+    if (e & 1)
+    {
+        // W_8^1 = (1 - j) / sqrt(2), W_8^3 = -j W_8^1
+        cpfb_t w;
+        w.re = (x.re + x.im) * rsqrt2;
+        w.im = (x.im - x.re) * rsqrt2;
+        y = pfb_rotate(w, e >> 1);
+    }
+    else
+    {
+        y = pfb_rotate(x, e >> 1);
+    }
+    return y;
+}
+
+/**
+ * @brief polyphase branches of a lane: the branches p = 8 w + lane, w = 0, ..., M / 8 - 1, time-multiplexed
+ *
+ * @tparam lane  input lane (each lane has its own engine)
+ * @param tvalid valid input word
+ * @param word   word of the block of the input word
+ * @param x      input sample of the lane
+ * @return output of the branch of the word (pfb_taps_per_branch valid words earlier)
+ */
+template <int lane>
+cacc_t pfb_branches(bool tvalid, pfb_word_t word, cdata_t x)
+{
+#pragma HLS INLINE
+    // coefficients of the branches of the lane: coef_bank[w][r] = h(r M + M - 1 - (8 w + lane))
+    coef_int_t coef_bank[pfb_words][pfb_taps_per_branch];
+    for (int w = 0; w < pfb_words; ++w)
+    {
+        for (int r = 0; r < pfb_taps_per_branch; ++r)
+        {
+            coef_bank[w][r] = pfb_coef[r * pfb_channels + pfb_channels - 1 - (ssr * w + lane)];
+        }
+    }
+    return multi_mac_systolic_tdm_bank<lane, pfb_taps_per_branch, pfb_words>(tvalid, word, x, coef_bank);
+}
+
+/**
+ * @brief SSR FFT of the branch outputs of a block, output word q (channels q + k1 M / 8 on lane k1)
+ */
+void pfb_fft_word(const cpfb_t branch[pfb_words][ssr], pfb_word_t q, cpfb_t y[ssr])
+{
+#pragma HLS INLINE
+    // M / 8-point DFT across the words of each lane (W_(M / 8)^(w q) = (-j)^(4 w q / (M / 8))), then twiddle W_M^(j q)
+    cpfb_t t[ssr];
+    for (int j = 0; j < ssr; ++j)
+    {
+#pragma HLS UNROLL
+        cpfb_t d = branch[0][j];
+        for (int w = 1; w < pfb_words; ++w)
+        {
+#pragma HLS UNROLL
+            d = pfb_add(d, pfb_rotate(branch[w][j], (4 / pfb_words) * w * q));
+        }
+        pfb_twiddle_t w_re;
+        pfb_twiddle_t w_im;
+        w_re.range() = pfb_twiddle_re[q][j];
+        w_im.range() = pfb_twiddle_im[q][j];
+        t[j].re = d.re * w_re - d.im * w_im;
+        t[j].im = d.re * w_im + d.im * w_re;
+    }
+
+    // 8-point FFT across the lanes: 4-point DFTs of the even and odd lanes, combined with W_8^k1
+    cpfb_t e[4];
+    cpfb_t o[4];
+    for (int h = 0; h < 2; ++h)
+    {
+#pragma HLS UNROLL
+        cpfb_t b0 = pfb_add(t[h], t[h + 4]);
+        cpfb_t b1 = pfb_sub(t[h], t[h + 4]);
+        cpfb_t b2 = pfb_add(t[h + 2], t[h + 6]);
+        cpfb_t b3 = pfb_rotate(pfb_sub(t[h + 2], t[h + 6]), 1);
+        cpfb_t *z = (h == 0) ? e : o;
+        z[0] = pfb_add(b0, b2);
+        z[1] = pfb_add(b1, b3);
+        z[2] = pfb_sub(b0, b2);
+        z[3] = pfb_sub(b1, b3);
+    }
+    for (int k = 0; k < 4; ++k)
+    {
+#pragma HLS UNROLL
+        cpfb_t ow = pfb_w8(o[k], k);
+        y[k] = pfb_add(e[k], ow);
+        y[k + 4] = pfb_sub(e[k], ow);
+    }
+}
+
+/**
+ * @brief polyphase filter bank channelizer, called every clock cycle
+ *
+ * @param tvalid_i valid input word
+ * @param tdata_i  input word
+ * @param sync_i   phase reset marker (set with the valid word that starts a block)
+ * @param tvalid_o valid output word
+ * @param tdata_o  output word: channels q + k1 M / 8 on lane k1 (q: word of the block)
+ * @param sync_o   phase reset marker (set with the first output word of the marked block)
+ */
+void pfb_channelizer(bool tvalid_i, const cdatain_vec_t<ssr> &tdata_i, bool sync_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o, bool &sync_o)
+{
+    // word of the block of the input word, the marked word starts a new block
+    static pfb_word_t word = 0;
+    pfb_word_t word_v = (tvalid_i && sync_i) ? pfb_word_t(0) : word;
+    if (tvalid_i)
+    {
+        word = (word_v == pfb_words - 1) ? pfb_word_t(0) : pfb_word_t(word_v + 1);
+    }
+
+    // the output is valid from the first block after power-up
+    static ap_uint<8> num_words = 0;
+    tvalid_o = tvalid_i && (num_words == pfb_latency);
+    if (tvalid_i && num_words < pfb_latency)
+    {
+        num_words++;
+    }
+
+    // align the phase reset marker to the first output word of the marked block
+    static ap_shift_reg<bool, pfb_latency> sync_shftreg;
+    sync_o = sync_shftreg.shift(tvalid_i && sync_i, pfb_latency - 1, tvalid_i) && tvalid_o;
+
+    // ----------------------------------------------
+    // polyphase branches
+    // ----------------------------------------------
+    cdata_t x[ssr];
+    for (int j = 0; j < ssr; ++j)
+    {
+#pragma HLS UNROLL
+        x[j].re = tdata_i.re[j];
+        x[j].im = tdata_i.im[j];
+    }
+    cacc_t v[ssr];
+    // not possible to create a loop because template instantiation
+    v[0] = pfb_branches<0>(tvalid_i, word_v, x[0]);
+    v[1] = pfb_branches<1>(tvalid_i, word_v, x[1]);
+    v[2] = pfb_branches<2>(tvalid_i, word_v, x[2]);
+    v[3] = pfb_branches<3>(tvalid_i, word_v, x[3]);
+    v[4] = pfb_branches<4>(tvalid_i, word_v, x[4]);
+    v[5] = pfb_branches<5>(tvalid_i, word_v, x[5]);
+    v[6] = pfb_branches<6>(tvalid_i, word_v, x[6]);
+    v[7] = pfb_branches<7>(tvalid_i, word_v, x[7]);
+
+    // ----------------------------------------------
+    // SSR FFT of the last complete block
+    // ----------------------------------------------
+    // branch outputs of the block being completed, and of the last complete block
+    static cpfb_t branch_buf[pfb_words][ssr];
+    static cpfb_t fft_buf[pfb_words][ssr];
+#pragma HLS ARRAY_PARTITION variable = branch_buf complete dim = 0
+#pragma HLS ARRAY_PARTITION variable = fft_buf complete dim = 0
+
+    cpfb_t y[ssr];
+    pfb_fft_word(fft_buf, word_v, y);
+
+    if (tvalid_i)
+    {
+        for (int j = 0; j < ssr; ++j)
+        {
+#pragma HLS UNROLL
+            branch_buf[word_v][j].re = v[j].re;
+            branch_buf[word_v][j].im = v[j].im;
+        }
+        if (word_v == pfb_words - 1)
+        {
+            for (int w = 0; w < pfb_words; ++w)
+            {
+#pragma HLS UNROLL
+                for (int j = 0; j < ssr; ++j)
+                {
+#pragma HLS UNROLL
+                    fft_buf[w][j] = branch_buf[w][j];
+                }
+            }
+        }
+    }
+
+    // output samples: division by M / 2 (same bits, binary point moved), rounded and saturated to the output data type
+    for (int k = 0; k < ssr; ++k)
+    {
+#pragma HLS UNROLL
+        pfb_scaled_t re;
+        pfb_scaled_t im;
+        re.range() = y[k].re.range();
+        im.range() = y[k].im.range();
+        tdata_o.re[k] = re;
+        tdata_o.im[k] = im;
+    }
+}
+
+#endif /* PFB_CHANNELIZER_H_ */
@@ -0,0 +1,47 @@
+/**
+ * @file pfb_coefs.h
+ * @brief prototype filter coefficients of the polyphase filter bank channelizer, one table per number of
+ *        channels (PFB_CHANNELS) and coefficient word length (COEF_BITS)
+ *
+ * @details
+ *  Generated by scripts/pfb_coefs.py - do not edit.
+ *  Kaiser-windowed sinc (beta = 8), pfb_taps_per_branch x PFB_CHANNELS taps, cut-off fs / (2 PFB_CHANNELS).
+ *  The coefficients are scaled by PFB_CHANNELS / 2 and are s<COEF_BITS>.<COEF_BITS - 1> integers.
+ *  The twiddle factors of the SSR FFT, W_M^(j q) = exp(-j 2 pi j q / M) for the lane j of the output word q,
+ *  are s18.16 integers.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef PFB_COEFS_H_
+#define PFB_COEFS_H_
+
+constexpr int pfb_taps_per_branch = 8;
+constexpr int pfb_num_taps = pfb_taps_per_branch * PFB_CHANNELS;
+
+#if PFB_CHANNELS == 16 && COEF_BITS == 18
+constexpr int pfb_coef[pfb_num_taps] = {-1, -6, -14, -26, -42, -63, -88, -115, -144, -170, -190, -201, -197, -174, -126, -50, 58, 198, 371, 573, 797, 1035, 1273, 1495, 1683, 1816, 1874, 1834, 1676, 1383, 944, 353, -390, -1272, -2274, -3363, -4497, -5625, -6685, -7608, -8321, -8746, -8808, -8437, -7568, -6150, -4145, -1534, 1683, 5484, 9823, 14632, 19824, 25289, 30903, 36530, 42025, 47240, 52030, 56260, 59807, 62564, 64450, 65408, 65408, 64450, 62564, 59807, 56260, 52030, 47240, 42025, 36530, 30903, 25289, 19824, 14632, 9823, 5484, 1683, -1534, -4145, -6150, -7568, -8437, -8808, -8746, -8321, -7608, -6685, -5625, -4497, -3363, -2274, -1272, -390, 353, 944, 1383, 1676, 1834, 1874, 1816, 1683, 1495, 1273, 1035, 797, 573, 371, 198, 58, -50, -126, -174, -197, -201, -190, -170, -144, -115, -88, -63, -42, -26, -14, -6, -1};
+#elif PFB_CHANNELS == 16 && COEF_BITS == 24
+constexpr int pfb_coef[pfb_num_taps] = {-77, -363, -868, -1634, -2686, -4025, -5615, -7378, -9186, -10862, -12178, -12861, -12611, -11112, -8058, -3184, 3706, 12703, 23764, 36674, 51031, 66227, 81443, 95665, 107707, 116255, 119927, 117350, 107248, 88541, 60445, 22581, -24936, -81411, -145508, -215214, -287833, -360023, -427855, -486930, -532518, -559733, -563741, -539976, -484376, -393609, -265286, -98158, 107738, 350970, 628656, 936472, 1268728, 1618497, 1977815, 2337925, 2689572, 3023329, 3329939, 3600667, 3827631, 4004112, 4124819, 4186104, 4186104, 4124819, 4004112, 3827631, 3600667, 3329939, 3023329, 2689572, 2337925, 1977815, 1618497, 1268728, 936472, 628656, 350970, 107738, -98158, -265286, -393609, -484376, -539976, -563741, -559733, -532518, -486930, -427855, -360023, -287833, -215214, -145508, -81411, -24936, 22581, 60445, 88541, 107248, 117350, 119927, 116255, 107707, 95665, 81443, 66227, 51031, 36674, 23764, 12703, 3706, -3184, -8058, -11112, -12611, -12861, -12178, -10862, -9186, -7378, -5615, -4025, -2686, -1634, -868, -363, -77};
+#elif PFB_CHANNELS == 16 && COEF_BITS == 27
+constexpr int pfb_coef[pfb_num_taps] = {-617, -2907, -6944, -13070, -21490, -32202, -44921, -59023, -73490, -86898, -97421, -102891, -100890, -88895, -64467, -25476, 29645, 101628, 190109, 293391, 408248, 529812, 651544, 765322, 861657, 930038, 959413, 938799, 857985, 708325, 483562, 180648, -199489, -651290, -1164065, -1721710, -2302668, -2880181, -3422840, -3895443, -4260144, -4477867, -4509927, -4319809, -3875010, -3148869, -2122292, -785266, 861908, 2807763, 5029244, 7491774, 10149822, 12947979, 15822523, 18703401, 21516576, 24186629, 26639514, 28805338, 30621048, 32032893, 32998555, 33488836, 33488836, 32998555, 32032893, 30621048, 28805338, 26639514, 24186629, 21516576, 18703401, 15822523, 12947979, 10149822, 7491774, 5029244, 2807763, 861908, -785266, -2122292, -3148869, -3875010, -4319809, -4509927, -4477867, -4260144, -3895443, -3422840, -2880181, -2302668, -1721710, -1164065, -651290, -199489, 180648, 483562, 708325, 857985, 938799, 959413, 930038, 861657, 765322, 651544, 529812, 408248, 293391, 190109, 101628, 29645, -25476, -64467, -88895, -100890, -102891, -97421, -86898, -73490, -59023, -44921, -32202, -21490, -13070, -6944, -2907, -617};
+#elif PFB_CHANNELS == 32 && COEF_BITS == 18
+constexpr int pfb_coef[pfb_num_taps] = {-1, -2, -5, -8, -12, -17, -24, -31, -40, -50, -61, -73, -85, -99, -113, -128, -143, -157, -170, -182, -193, -201, -206, -208, -206, -199, -187, -169, -144, -113, -74, -27, 29, 92, 164, 244, 332, 428, 531, 639, 754, 872, 992, 1113, 1234, 1352, 1464, 1569, 1664, 1746, 1814, 1863, 1892, 1897, 1876, 1827, 1746, 1633, 1485, 1301, 1079, 819, 520, 183, -192, -603, -1047, -1524, -2028, -2557, -3105, -3667, -4238, -4811, -5378, -5932, -6464, -6966, -7430, -7845, -8202, -8492, -8705, -8832, -8863, -8789, -8603, -8295, -7859, -7288, -6576, -5719, -4714, -3557, -2248, -787, 825, 2585, 4488, 6530, 8703, 10998, 13406, 15916, 18515, 21189, 23924, 26704, 29514, 32335, 35150, 37941, 40689, 43377, 45985, 48496, 50892, 53156, 55272, 57223, 58996, 60578, 61957, 63123, 64066, 64779, 65258, 65498, 65498, 65258, 64779, 64066, 63123, 61957, 60578, 58996, 57223, 55272, 53156, 50892, 48496, 45985, 43377, 40689, 37941, 35150, 32335, 29514, 26704, 23924, 21189, 18515, 15916, 13406, 10998, 8703, 6530, 4488, 2585, 825, -787, -2248, -3557, -4714, -5719, -6576, -7288, -7859, -8295, -8603, -8789, -8863, -8832, -8705, -8492, -8202, -7845, -7430, -6966, -6464, -5932, -5378, -4811, -4238, -3667, -3105, -2557, -2028, -1524, -1047, -603, -192, 183, 520, 819, 1079, 1301, 1485, 1633, 1746, 1827, 1876, 1897, 1892, 1863, 1814, 1746, 1664, 1569, 1464, 1352, 1234, 1113, 992, 872, 754, 639, 531, 428, 332, 244, 164, 92, 29, -27, -74, -113, -144, -169, -187, -199, -206, -208, -206, -201, -193, -182, -170, -157, -143, -128, -113, -99, -85, -73, -61, -50, -40, -31, -24, -17, -12, -8, -5, -2, -1};
+#elif PFB_CHANNELS == 32 && COEF_BITS == 24
+constexpr int pfb_coef[pfb_num_taps] = {-38, -147, -302, -512, -782, -1117, -1522, -2001, -2553, -3180, -3880, -4646, -5472, -6347, -7259, -8191, -9122, -10031, -10890, -11671, -12341, -12865, -13207, -13328, -13189, -12749, -11969, -10809, -9234, -7209, -4705, -1698, 1831, 5893, 10490, 15618, 21259, 27386, 33959, 40927, 48225, 55776, 63489, 71260, 78972, 86496, 93693, 100412, 106493, 111772, 116076, 119230, 121061, 121395, 120063, 116905, 111771, 104525, 95049, 83245, 69040, 52385, 33263, 11691, -12282, -38565, -67033, -97515, -129799, -163633, -198719, -234716, -271245, -307883, -344173, -379619, -413697, -445854, -475514, -502082, -524952, -543511, -557146, -565251, -567232, -562518, -550565, -530864, -502949, -466403, -420866, -366039, -301693, -227673, -143902, -50387, 52781, 165421, 287260, 417937, 556998, 703901, 858014, 1018625, 1184939, 1356089, 1531136, 1709083, 1888878, 2069424, 2249587, 2428210, 2604115, 2776124, 2943060, 3103766, 3257109, 3401996, 3537382, 3662280, 3775772, 3877018, 3965261, 4039841, 4100195, 4145866, 4176508, 4191887, 4191887, 4176508, 4145866, 4100195, 4039841, 3965261, 3877018, 3775772, 3662280, 3537382, 3401996, 3257109, 3103766, 2943060, 2776124, 2604115, 2428210, 2249587, 2069424, 1888878, 1709083, 1531136, 1356089, 1184939, 1018625, 858014, 703901, 556998, 417937, 287260, 165421, 52781, -50387, -143902, -227673, -301693, -366039, -420866, -466403, -502949, -530864, -550565, -562518, -567232, -565251, -557146, -543511, -524952, -502082, -475514, -445854, -413697, -379619, -344173, -307883, -271245, -234716, -198719, -163633, -129799, -97515, -67033, -38565, -12282, 11691, 33263, 52385, 69040, 83245, 95049, 104525, 111771, 116905, 120063, 121395, 121061, 119230, 116076, 111772, 106493, 100412, 93693, 86496, 78972, 71260, 63489, 55776, 48225, 40927, 33959, 27386, 21259, 15618, 10490, 5893, 1831, -1698, -4705, -7209, -9234, -10809, -11969, -12749, -13189, -13328, -13207, -12865, -12341, -11671, -10890, -10031, -9122, -8191, -7259, -6347, -5472, -4646, -3880, -3180, -2553, -2001, -1522, -1117, -782, -512, -302, -147, -38};
+#elif PFB_CHANNELS == 32 && COEF_BITS == 27
+constexpr int pfb_coef[pfb_num_taps] = {-308, -1174, -2420, -4097, -6256, -8938, -12179, -16004, -20427, -25443, -31036, -37166, -43775, -50780, -58074, -65527, -72979, -80246, -87120, -93365, -98725, -102921, -105658, -106628, -105513, -101994, -95750, -86473, -73870, -57673, -37643, -13587, 14645, 47140, 83924, 124945, 170072, 219085, 271670, 327414, 385801, 446210, 507913, 570079, 631775, 691970, 749544, 803293, 851946, 894173, 928604, 953843, 968490, 971158, 960503, 935238, 894166, 836200, 760394, 665963, 552317, 419076, 266105, 93526, -98252, -308523, -536262, -780116, -1038395, -1309064, -1589748, -1877730, -2169958, -2463066, -2753381, -3036954, -3309580, -3566836, -3804112, -4016657, -4199617, -4348089, -4457169, -4522005, -4537855, -4500144, -4404519, -4246911, -4023591, -3731224, -3366925, -2928311, -2413546, -1821387, -1151220, -403094, 422251, 1323368, 2298083, 3343498, 4455986, 5631205, 6864114, 8149001, 9479516, 10848710, 12249089, 13672666, 15111026, 16555392, 17996700, 19425676, 20832921, 22208990, 23544482, 24830127, 26056871, 27215968, 28299054, 29298239, 30206177, 31016141, 31722091, 32318729, 32801559, 33166928, 33412063, 33535098, 33535098, 33412063, 33166928, 32801559, 32318729, 31722091, 31016141, 30206177, 29298239, 28299054, 27215968, 26056871, 24830127, 23544482, 22208990, 20832921, 19425676, 17996700, 16555392, 15111026, 13672666, 12249089, 10848710, 9479516, 8149001, 6864114, 5631205, 4455986, 3343498, 2298083, 1323368, 422251, -403094, -1151220, -1821387, -2413546, -2928311, -3366925, -3731224, -4023591, -4246911, -4404519, -4500144, -4537855, -4522005, -4457169, -4348089, -4199617, -4016657, -3804112, -3566836, -3309580, -3036954, -2753381, -2463066, -2169958, -1877730, -1589748, -1309064, -1038395, -780116, -536262, -308523, -98252, 93526, 266105, 419076, 552317, 665963, 760394, 836200, 894166, 935238, 960503, 971158, 968490, 953843, 928604, 894173, 851946, 803293, 749544, 691970, 631775, 570079, 507913, 446210, 385801, 327414, 271670, 219085, 170072, 124945, 83924, 47140, 14645, -13587, -37643, -57673, -73870, -86473, -95750, -101994, -105513, -106628, -105658, -102921, -98725, -93365, -87120, -80246, -72979, -65527, -58074, -50780, -43775, -37166, -31036, -25443, -20427, -16004, -12179, -8938, -6256, -4097, -2420, -1174, -308};
+#endif
+
+#if PFB_CHANNELS == 16
+constexpr int pfb_twiddle_re[PFB_CHANNELS / 8][8] = {{65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536}, {65536, 60547, 46341, 25080, 0, -25080, -46341, -60547}};
+constexpr int pfb_twiddle_im[PFB_CHANNELS / 8][8] = {{0, 0, 0, 0, 0, 0, 0, 0}, {0, -25080, -46341, -60547, -65536, -60547, -46341, -25080}};
+#elif PFB_CHANNELS == 32
+constexpr int pfb_twiddle_re[PFB_CHANNELS / 8][8] = {{65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536}, {65536, 64277, 60547, 54491, 46341, 36410, 25080, 12785}, {65536, 60547, 46341, 25080, 0, -25080, -46341, -60547}, {65536, 54491, 25080, -12785, -46341, -64277, -60547, -36410}};
+constexpr int pfb_twiddle_im[PFB_CHANNELS / 8][8] = {{0, 0, 0, 0, 0, 0, 0, 0}, {0, -12785, -25080, -36410, -46341, -54491, -60547, -64277}, {0, -25080, -46341, -60547, -65536, -60547, -46341, -25080}, {0, -36410, -60547, -64277, -46341, -12785, 25080, 54491}};
+#endif
+
+#endif /* PFB_COEFS_H_ */
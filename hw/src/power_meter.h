@@ -0,0 +1,90 @@
+/**
+ * @file power_meter.h
+ * @brief integrate-and-dump power meter (RSSI) of a decimator output
+ *
+ * @details
+ *  Accumulates |I|^2 + |Q|^2 of all the samples of length valid words (ssr lanes per word, the unused lanes are zero),
+ *  then dumps the sum into the result register and restarts the integration:
+ *  - power: sum of I^2 + Q^2 over the last integration period, in units of the squared lsb of dataout_t
+ *  - count: number of integration periods completed (incremented at every dump)
+ *  The mean power per sample is power / (length * number of valid lanes), e.g. 1 lane for dec_factor >= 8.
+ *  The length is sampled at the start of each integration period (0 is handled as 1, and the length is saturated
+ *  to pwr_len_max so that the 64-bit sum cannot overflow, see ssr_multistage_decimator.h).
+ *
+ *  The power and the count are latched when an integration period completes, and hold their value while hold is set:
+ *  a 64-bit power read as two 32-bit AXI-Lite registers cannot tear if the host sets hold, reads count and
+ *  the low and high halves of power, then clears hold. The integration goes on while hold is set, the registers
+ *  show the last completed period when hold is cleared.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef POWER_METER_H_
+#define POWER_METER_H_
+
+#include "ssr_multistage_decimator.h"
+
+/**
+ * @brief integrate-and-dump power meter, called every clock cycle
+ *
+ * @tparam instance_id  instance of the meter (each instance has its own state)
+ * @param tvalid        valid flag of the input word
+ * @param tdata         input word
+ * @param length        integration length (number of valid words, saturated to pwr_len_max)
+ * @param hold          hold the power and count outputs
+ * @param power         power of the last integration period
+ * @param count         number of integration periods completed
+ */
+template <int instance_id>
+void power_meter(bool tvalid, const cdataout_vec_t<ssr> &tdata, pwr_len_t length, bool hold, pwr_acc_t &power, axil_reg_t &count)
+{
+    static pwr_acc_t acc = 0;
+    static ap_uint<pwr_len_bits> num_words = 0;
+    static ap_uint<pwr_len_bits> length_r = 1;
+    static pwr_acc_t power_r = 0;
+    static axil_reg_t count_r = 0;
+    static pwr_acc_t power_o = 0;
+    static axil_reg_t count_o = 0;
+
+    if (tvalid)
+    {
+        // power of the word
+        ap_uint<2 * dataout_bits + 4> word_power = 0;
+        for (int i = 0; i < ssr; ++i)
+        {
+#pragma HLS UNROLL
+            ap_int<dataout_bits> re = tdata.re[i].range();
+            ap_int<dataout_bits> im = tdata.im[i].range();
+            word_power += ap_uint<2 * dataout_bits>(re * re) + ap_uint<2 * dataout_bits>(im * im);
+        }
+
+        // the integration length is sampled at the start of each period
+        if (num_words == 0)
+        {
+            length_r = (length == 0) ? pwr_len_t(1) : (length > pwr_len_max) ? pwr_len_t(pwr_len_max) : length;
+        }
+
+        acc += word_power;
+        num_words++;
+        if (num_words == length_r)
+        {
+            power_r = acc;
+            count_r++;
+            acc = 0;
+            num_words = 0;
+        }
+    }
+
+    if (!hold)
+    {
+        power_o = power_r;
+        count_o = count_r;
+    }
+    power = power_o;
+    count = count_o;
+}
+
+#endif /* POWER_METER_H_ */
@@ -0,0 +1,115 @@
+/**
+ * @file snapshot.h
+ * @brief on-chip snapshot capture of a tap point of the decimator
+ *
+ * @details
+ *  Records snap_length consecutive valid words (ssr complex samples) of the selected tap point
+ *  (input, dec2, ..., dec64) into a capture buffer, starting at the trigger:
+ *  - arm:      a rising edge of snap_arm clears the buffer status and arms the capture
+ *  - trigger:  the first clock with trigger high after the arm starts the capture (the word of that clock included)
+ *  - capture:  every valid word of the tap is written to the buffer until snap_length words are captured
+ *  - readout:  snap_rd_data = sample snap_rd_addr % ssr of word snap_rd_addr / ssr, {im[31:16], re[15:0]}
+ *
+ *  Status register (snap_status):
+ *  - [15:0]  number of captured words
+ *  - [29]    capturing
+ *  - [30]    armed (waiting for the trigger)
+ *  - [31]    done
+ *
+ *  The buffer is a simple dual port memory (ram_s2p): the capture writes one word per clock cycle,
+ *  the readout reads one word per clock cycle. Define SNAPSHOT_URAM to map the buffer to URAM instead of BRAM.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "ssr_multistage_decimator.h"
+
+/**
+ * @brief snapshot capture, called every clock cycle
+ *
+ * @tparam depth       number of words of the capture buffer
+ * @param tap          tap point to be captured (0: input, 1: dec2, ..., 6: dec64), sampled at the trigger
+ * @param length       number of words to be captured (0 or more than depth: depth)
+ * @param arm          arm the capture (rising edge)
+ * @param trigger      start the capture
+ * @param tvalid_tap   valid flag of each tap point
+ * @param tdata_tap    output words of each tap point
+ * @param rd_addr      read address (word * ssr + lane)
+ * @param rd_data      read data
+ * @param status       status register
+ */
+template <int depth>
+void snapshot_capture(snapshot_tap_t tap, snapshot_len_t length, bool arm, bool trigger,
+                      const bool tvalid_tap[num_taps], const cdataout_vec_t<ssr> tdata_tap[num_taps],
+                      snapshot_addr_t rd_addr, axil_reg_t &rd_data, axil_reg_t &status)
+{
+    static cdataout_vec_t<ssr> buffer[depth];
+#pragma HLS AGGREGATE variable = buffer
+#ifdef SNAPSHOT_URAM
+#pragma HLS BIND_STORAGE variable = buffer type = ram_s2p impl = uram
+#else
+#pragma HLS BIND_STORAGE variable = buffer type = ram_s2p impl = bram
+#endif
+#pragma HLS DEPENDENCE variable = buffer inter false
+
+    static bool arm_r = false;
+    static bool armed = false;
+    static bool capturing = false;
+    static bool done = false;
+    static snapshot_tap_t tap_r = 0;
+    static snapshot_len_t length_r = depth;
+    static snapshot_len_t count = 0;
+
+    // readout
+    cdataout_vec_t<ssr> word = buffer[rd_addr / ssr];
+    int lane = rd_addr % ssr;
+    ap_int<16> rd_re = ap_int<dataout_bits>(word.re[lane].range());
+    ap_int<16> rd_im = ap_int<dataout_bits>(word.im[lane].range());
+    rd_data.range(15, 0) = rd_re;
+    rd_data.range(31, 16) = rd_im;
+
+    // capture
+    bool arm_edge = arm && !arm_r;
+    arm_r = arm;
+    if (arm_edge)
+    {
+        armed = true;
+        capturing = false;
+        done = false;
+        count = 0;
+    }
+    else
+    {
+        if (armed && trigger)
+        {
+            armed = false;
+            capturing = true;
+            tap_r = (tap < num_taps) ? tap : snapshot_tap_t(0);
+            length_r = (length == 0 || length > depth) ? snapshot_len_t(depth) : length;
+        }
+        if (capturing && tvalid_tap[tap_r])
+        {
+            buffer[count] = tdata_tap[tap_r];
+            count++;
+            if (count == length_r)
+            {
+                capturing = false;
+                done = true;
+            }
+        }
+    }
+
+    status = 0;
+    status.range(15, 0) = count;
+    status[29] = capturing;
+    status[30] = armed;
+    status[31] = done;
+}
+
+#endif /* SNAPSHOT_H_ */
@@ -25,6 +25,11 @@
 
 #include "ssr_multistage_decimator.h"
 #include "dec_filters.h"
+#include "bfp_compress.h"
+#include "snapshot.h"
+#include "power_meter.h"
+#include "pfb_channelizer.h"
+#include "int_filters.h"
 
  /**
   * @brief write decimator output data to output port
@@ -34,6 +39,12 @@ template <int N>
 cdataout_vec_t<ssr> copy_data(cdata_vec_t<N> tdata_i)
 {
     cdataout_vec_t<ssr> tdata_o;
+    // unused output lanes are set to zero
+    for (int i = N; i < ssr; ++i) {
+    #pragma HLS UNROLL
+        tdata_o.re[i] = 0;
+        tdata_o.im[i] = 0;
+    }
     for (int i = 0; i < N; ++i) {
     #pragma HLS UNROLL
         tdata_o.re[i] = tdata_i.re[i];
@@ -74,29 +85,42 @@ cdataout_vec_t<ssr> copy_data(cdatain_vec_t<ssr> tdata_i)
     return tdata_o;
 }
 
-// 
 /**
- * @brief Performs multistage decimation on the input data.
+ * @brief Runs the cascade of decimation stages and returns the output of every stage (tap points).
  *
- * This function takes the input data and applies multistage decimation with the given decimation factor.
- * The input data is a vector of complex data samples, and the output data is also a vector of complex data samples.
+ * The decimation phase reset is a marker that travels with the data through the stages: it is attached to the
+ * first valid input word at or after a rising edge of phase_reset_i, and every stage starts a new decimation period
+ * at the marked sample. The outputs after the reset are then the input samples n0 + k dec_factor (n0: lane 0 of the
+ * marked word), whatever the gaps of the input stream. Being edge sensitive, phase_reset_i can be driven by a SYSREF
+ * (sync) signal shared by several decimators: all of them keep the same input samples.
  *
- * @param dec_factor The decimation factor to be applied.
  * @param tvalid_i The validity flag of the input data.
  * @param tdata_i The input data vector.
- * @param tvalid_o The validity flag of the output data.
- * @param tdata_o The output data vector.
+ * @param phase_reset_i Reset the decimation phase (applied to the first valid input word at or after the rising edge).
+ * @param tvalid_tap The validity flag of each tap point (0: input, 1: dec2, ..., 6: dec64).
+ * @param tdata_tap The data vector of each tap point, in the format of the output port.
+ * @param sync_tap The phase reset marker of each tap point (set with the valid word of the marked sample).
+ * @param iq_overflow_o A sample was dropped by the queue of dec32 or dec64 (IQ_TDM, see dec2_ssr1_iq, sticky).
  */
-void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool& tvalid_o, cdataout_vec_t<ssr>& tdata_o)
+void decimator_taps(bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool tvalid_tap[num_taps], cdataout_vec_t<ssr> tdata_tap[num_taps],
+                    bool sync_tap[num_taps], bool &iq_overflow_o)
 {
-
+    // ----------------------------------------------------
+    // decimation phase reset: mark the first valid input word at or after the rising edge
+    // ----------------------------------------------------
+    static bool phase_reset_r = false;
+    static bool phase_reset_pending = false;
+    bool phase_reset = (phase_reset_i && !phase_reset_r) || phase_reset_pending;
+    phase_reset_r = phase_reset_i;
+    phase_reset_pending = phase_reset && !tvalid_i;
 
     // ----------------------------------------------------
     // first filter stage (decimation factor = 2)
     // ----------------------------------------------------
     bool tvalid_dec2;
     cdata_vec_t<8> tdata_o_dec2;
-    dec2_ssr8(tvalid_i, tdata_i, tvalid_dec2, tdata_o_dec2);
+    bool phase_reset_dec2;
+    dec2_ssr8(tvalid_i, tdata_i, phase_reset, tvalid_dec2, tdata_o_dec2, phase_reset_dec2);
 
     // ----------------------------------------------------
     // second filter stage (decimation factor = 4)
@@ -104,8 +128,9 @@ void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_ve
     bool tvalid_dec4;
     cdata_vec_t<4> tdata_i_dec4;
     cdata_vec_t<4> tdata_o_dec4;
+    bool phase_reset_dec4;
     tdata_i_dec4 = read_data<4>(tdata_o_dec2);
-    dec2_ssr4(tvalid_dec2, tdata_i_dec4, tvalid_dec4, tdata_o_dec4);
+    dec2_ssr4(tvalid_dec2, tdata_i_dec4, phase_reset_dec2, tvalid_dec4, tdata_o_dec4, phase_reset_dec4);
 
     // ----------------------------------------------------
     // third filter stage (decimation factor = 8)
@@ -113,8 +138,9 @@ void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_ve
     bool tvalid_dec8;
     cdata_vec_t<2> tdata_i_dec8;
     cdata_vec_t<2> tdata_o_dec8;
+    bool phase_reset_dec8;
     tdata_i_dec8 = read_data<2>(tdata_o_dec4);
-    dec2_ssr2(tvalid_dec4, tdata_i_dec8, tvalid_dec8, tdata_o_dec8);
+    dec2_ssr2(tvalid_dec4, tdata_i_dec8, phase_reset_dec4, tvalid_dec8, tdata_o_dec8, phase_reset_dec8);
 
     // ----------------------------------------------------
     // fourth filter stage (decimation factor = 16)
@@ -122,47 +148,91 @@ void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_ve
     bool tvalid_dec16;
     cdata_vec_t<1> tdata_i_dec16;
     cdata_vec_t<1> tdata_dec16;
+    bool phase_reset_dec16;
     tdata_i_dec16 = read_data<1>(tdata_o_dec8);
-    dec2_ssr1<16>(tvalid_dec8, tdata_i_dec16, tvalid_dec16, tdata_dec16);
+    dec2_ssr1<16>(tvalid_dec8, tdata_i_dec16, phase_reset_dec8, tvalid_dec16, tdata_dec16, phase_reset_dec16);
 
     // ----------------------------------------------------
     // fifth filter stage (decimation factor = 32)
     // ----------------------------------------------------
     bool tvalid_dec32;
     cdata_vec_t<1> tdata_dec32;
-    dec2_ssr1<32>(tvalid_dec16, tdata_dec16, tvalid_dec32, tdata_dec32);
+    bool phase_reset_dec32;
+    bool overflow_dec32 = false;
+#ifdef IQ_TDM
+    dec2_ssr1_iq<32>(tvalid_dec16, tdata_dec16, phase_reset_dec16, tvalid_dec32, tdata_dec32, phase_reset_dec32, overflow_dec32);
+#else
+    dec2_ssr1<32>(tvalid_dec16, tdata_dec16, phase_reset_dec16, tvalid_dec32, tdata_dec32, phase_reset_dec32);
+#endif
 
     // ----------------------------------------------------
     // sixth filter stage (decimation factor = 64)
     // ----------------------------------------------------
     bool tvalid_dec64;
     cdata_vec_t<1> tdata_dec64;
-    dec2_ssr1<64>(tvalid_dec32, tdata_dec32, tvalid_dec64, tdata_dec64);
+    bool phase_reset_dec64;
+    bool overflow_dec64 = false;
+#ifdef IQ_TDM
+    dec2_ssr1_iq<64>(tvalid_dec32, tdata_dec32, phase_reset_dec32, tvalid_dec64, tdata_dec64, phase_reset_dec64, overflow_dec64);
+#else
+    dec2_ssr1<64>(tvalid_dec32, tdata_dec32, phase_reset_dec32, tvalid_dec64, tdata_dec64, phase_reset_dec64);
+#endif
+    iq_overflow_o = overflow_dec32 || overflow_dec64;
 
     // ----------------------------------------------------
-    // select the output data based on the decimation factor
+    // tap points
     // ----------------------------------------------------
+    tvalid_tap[0] = tvalid_i;
+    tdata_tap[0] = copy_data(tdata_i);
+    tvalid_tap[1] = tvalid_dec2;
+    tdata_tap[1] = copy_data<8>(tdata_o_dec2);
+    tvalid_tap[2] = tvalid_dec4;
+    tdata_tap[2] = copy_data<4>(tdata_o_dec4);
+    tvalid_tap[3] = tvalid_dec8;
+    tdata_tap[3] = copy_data<2>(tdata_o_dec8);
+    tvalid_tap[4] = tvalid_dec16;
+    tdata_tap[4] = copy_data<1>(tdata_dec16);
+    tvalid_tap[5] = tvalid_dec32;
+    tdata_tap[5] = copy_data<1>(tdata_dec32);
+    tvalid_tap[6] = tvalid_dec64;
+    tdata_tap[6] = copy_data<1>(tdata_dec64);
+
+    sync_tap[0] = tvalid_i && phase_reset;
+    sync_tap[1] = phase_reset_dec2;
+    sync_tap[2] = phase_reset_dec4;
+    sync_tap[3] = phase_reset_dec8;
+    sync_tap[4] = phase_reset_dec16;
+    sync_tap[5] = phase_reset_dec32;
+    sync_tap[6] = phase_reset_dec64;
+}
+
+/**
+ * @brief select the output data based on the decimation factor
+ *
+ */
+void select_tap(dec_factor_t dec_factor, const bool tvalid_tap[num_taps], const cdataout_vec_t<ssr> tdata_tap[num_taps], bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o)
+{
     if (dec_factor == 1) {
-        tvalid_o = tvalid_i;
-        tdata_o = copy_data(tdata_i);
+        tvalid_o = tvalid_tap[0];
+        tdata_o = tdata_tap[0];
     } else if (dec_factor == 2) {
-        tvalid_o = tvalid_dec2;
-        tdata_o = copy_data<8>(tdata_o_dec2);
+        tvalid_o = tvalid_tap[1];
+        tdata_o = tdata_tap[1];
     } else if (dec_factor == 4) {
-        tvalid_o = tvalid_dec4;
-        tdata_o =  copy_data<4>(tdata_o_dec4);
+        tvalid_o = tvalid_tap[2];
+        tdata_o = tdata_tap[2];
     } else if (dec_factor == 8) {
-        tvalid_o = tvalid_dec8;
-        tdata_o = copy_data<2>(tdata_o_dec8);
+        tvalid_o = tvalid_tap[3];
+        tdata_o = tdata_tap[3];
     } else if (dec_factor == 16) {
-        tvalid_o = tvalid_dec16;
-        tdata_o = copy_data<1>(tdata_dec16);
+        tvalid_o = tvalid_tap[4];
+        tdata_o = tdata_tap[4];
     } else if (dec_factor == 32) {
-        tvalid_o = tvalid_dec32;
-        tdata_o = copy_data<1>(tdata_dec32);
+        tvalid_o = tvalid_tap[5];
+        tdata_o = tdata_tap[5];
     } else if (dec_factor == 64) {
-        tvalid_o = tvalid_dec64;
-        tdata_o = copy_data<1>(tdata_dec64);
+        tvalid_o = tvalid_tap[6];
+        tdata_o = tdata_tap[6];
     } else {
         tvalid_o = false;
         for (int i = 0; i < ssr; ++i) {
@@ -171,4 +241,651 @@ void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_ve
             tdata_o.im[i] = 0;
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief sample index sideband of the output selected by dec_factor
+ *
+ * The index of the input sample of lane 0 of every valid output word: 0 for the word of the phase reset marker,
+ * then it advances by the input samples per output word (ssr for dec_factor <= ssr, dec_factor above).
+ * The marker is delayed with the data through the stages, so the index is aligned with the output word
+ * without carrying it through the pipeline. Decimators synchronized by the same phase reset output the same
+ * index for the same input sample, so the channels of several boards can be aligned by the host.
+ * The index is meaningless before the first phase reset and after a change of dec_factor (until the next one).
+ */
+void sample_counter(dec_factor_t dec_factor, bool tvalid, bool sync, sample_index_t &sample_index_o)
+{
+    static sample_index_t index = 0;
+    static sample_index_t next_index = 0;
+
+    if (tvalid) {
+        index = sync ? sample_index_t(0) : next_index;
+        next_index = index + ((dec_factor < ssr) ? dec_factor_t(ssr) : dec_factor);
+    }
+    sample_index_o = index;
+}
+
+/**
+ * @brief select the phase reset marker of the output selected by dec_factor (same mapping as select_tap)
+ *
+ */
+bool select_sync(dec_factor_t dec_factor, const bool sync_tap[num_taps])
+{
+    bool sync = false;
+    for (int tap = 0; tap < num_taps; ++tap) {
+    #pragma HLS UNROLL
+        if (dec_factor == (1 << tap)) {
+            sync = sync_tap[tap];
+        }
+    }
+    return sync;
+}
+
+// 
+/**
+ * @brief Performs multistage decimation on the input data.
+ *
+ * This function takes the input data and applies multistage decimation with the given decimation factor.
+ * The input data is a vector of complex data samples, and the output data is also a vector of complex data samples.
+ *
+ * @param dec_factor The decimation factor to be applied.
+ * @param tvalid_i The validity flag of the input data.
+ * @param tdata_i The input data vector.
+ * @param phase_reset_i Reset the decimation phase, rising edge (see decimator_taps).
+ * @param tvalid_o The validity flag of the output data.
+ * @param tdata_o The output data vector.
+ * @param sample_index_o Index of the input sample of lane 0 of the output word (see sample_counter).
+ */
+void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool& tvalid_o, cdataout_vec_t<ssr>& tdata_o,
+                              sample_index_t& sample_index_o)
+{
+    bool tvalid_tap[num_taps];
+    cdataout_vec_t<ssr> tdata_tap[num_taps];
+    bool sync_tap[num_taps];
+#pragma HLS ARRAY_PARTITION variable = tvalid_tap complete
+#pragma HLS ARRAY_PARTITION variable = tdata_tap complete
+#pragma HLS ARRAY_PARTITION variable = sync_tap complete
+
+    // the overflow flag of IQ_TDM is a register of ssr_multistage_decimator_mon
+    bool iq_overflow;
+    decimator_taps(tvalid_i, tdata_i, phase_reset_i, tvalid_tap, tdata_tap, sync_tap, iq_overflow);
+    select_tap(dec_factor, tvalid_tap, tdata_tap, tvalid_o, tdata_o);
+    sample_counter(dec_factor, tvalid_o, select_sync(dec_factor, sync_tap), sample_index_o);
+}
+
+/**
+ * @brief Multistage decimator with monitoring functions.
+ *
+ * Same processing as ssr_multistage_decimator, plus:
+ * - a snapshot capture buffer that records the output of any tap point on a trigger (trigger_i port or snap_force register),
+ *   readable through AXI-Lite (see snapshot.h)
+ * - an integrate-and-dump power meter of the output or of any tap point (see power_meter.h)
+ * - the overflow flag of the queues of the I/Q time-multiplexed stages (IQ_TDM, see dec2_ssr1_iq)
+ *
+ * @param dec_factor The decimation factor to be applied.
+ * @param tvalid_i The validity flag of the input data.
+ * @param tdata_i The input data vector.
+ * @param phase_reset_i Reset the decimation phase, rising edge (see decimator_taps).
+ * @param tvalid_o The validity flag of the output data.
+ * @param tdata_o The output data vector.
+ * @param sample_index_o Index of the input sample of lane 0 of the output word (see sample_counter).
+ * @param trigger_i Snapshot trigger input.
+ * @param snap_tap Snapshot tap point (0: input, 1: dec2, ..., 6: dec64).
+ * @param snap_length Snapshot length (number of words).
+ * @param snap_arm Arm the snapshot capture (rising edge).
+ * @param snap_force Software trigger.
+ * @param snap_rd_addr Snapshot read address (word * ssr + lane).
+ * @param snap_rd_data Snapshot read data.
+ * @param snap_status Snapshot status.
+ * @param pwr_src Power meter input (0: output, 1..7: tap point 0..6).
+ * @param pwr_length Power meter integration length (number of valid words, at most pwr_len_max).
+ * @param pwr_hold Hold pwr_sum and pwr_count (coherent read of the two 32-bit halves of pwr_sum).
+ * @param pwr_sum Power of the last integration period.
+ * @param pwr_count Number of integration periods completed.
+ * @param iq_overflow A sample was dropped by the queue of dec32 or dec64 (IQ_TDM, see dec2_ssr1_iq, sticky).
+ */
+void ssr_multistage_decimator_mon(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o, sample_index_t &sample_index_o,
+                                  bool trigger_i, snapshot_tap_t snap_tap, snapshot_len_t snap_length, bool snap_arm, bool snap_force,
+                                  snapshot_addr_t snap_rd_addr, axil_reg_t &snap_rd_data, axil_reg_t &snap_status,
+                                  pwr_src_t pwr_src, pwr_len_t pwr_length, bool pwr_hold, pwr_acc_t &pwr_sum, axil_reg_t &pwr_count,
+                                  bool &iq_overflow)
+{
+    bool tvalid_tap[num_taps];
+    cdataout_vec_t<ssr> tdata_tap[num_taps];
+    bool sync_tap[num_taps];
+#pragma HLS ARRAY_PARTITION variable = tvalid_tap complete
+#pragma HLS ARRAY_PARTITION variable = tdata_tap complete
+#pragma HLS ARRAY_PARTITION variable = sync_tap complete
+
+    decimator_taps(tvalid_i, tdata_i, phase_reset_i, tvalid_tap, tdata_tap, sync_tap, iq_overflow);
+    select_tap(dec_factor, tvalid_tap, tdata_tap, tvalid_o, tdata_o);
+    sample_counter(dec_factor, tvalid_o, select_sync(dec_factor, sync_tap), sample_index_o);
+
+    snapshot_capture<snapshot_depth>(snap_tap, snap_length, snap_arm, trigger_i || snap_force,
+                                     tvalid_tap, tdata_tap, snap_rd_addr, snap_rd_data, snap_status);
+
+    bool tvalid_pwr = (pwr_src == 0) ? tvalid_o : tvalid_tap[pwr_src - 1];
+    cdataout_vec_t<ssr> tdata_pwr = (pwr_src == 0) ? tdata_o : tdata_tap[pwr_src - 1];
+    power_meter<0>(tvalid_pwr, tdata_pwr, pwr_length, pwr_hold, pwr_sum, pwr_count);
+}
+
+/**
+ * @brief Multistage decimator with block floating point (BFP) compressed output.
+ *
+ * The valid lanes of consecutive output words (8 / dec_factor lanes, one above dec_factor 8) are packed into blocks
+ * of ssr samples, and each full block is compressed with a shared exponent and bfp_mant_bits mantissas
+ * (see bfp_compress.h): tvalid_o is set once per block, so every bit of the output link carries a valid sample
+ * (2 bfp_mant_bits + 1 bits per complex sample at every decimation factor).
+ * Block k holds the output samples 8 k .. 8 k + 7 counted from the phase reset: the output word of the phase reset
+ * starts a new block (the samples of a partial block are dropped). A partial block waits for the next output words.
+ *
+ * @param dec_factor The decimation factor to be applied.
+ * @param tvalid_i The validity flag of the input data.
+ * @param tdata_i The input data vector.
+ * @param phase_reset_i Reset the decimation phase, rising edge (see decimator_taps).
+ * @param tvalid_o The validity flag of the output block.
+ * @param tdata_o The compressed output block.
+ * @param sample_index_o Index of the input sample of the first output sample of the block (see sample_counter).
+ */
+void ssr_multistage_decimator_bfp(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, bfp_block_t<bfp_mant_bits> &tdata_o,
+                                  sample_index_t &sample_index_o)
+{
+    bool tvalid_tap[num_taps];
+    cdataout_vec_t<ssr> tdata_tap[num_taps];
+    bool sync_tap[num_taps];
+#pragma HLS ARRAY_PARTITION variable = tvalid_tap complete
+#pragma HLS ARRAY_PARTITION variable = tdata_tap complete
+#pragma HLS ARRAY_PARTITION variable = sync_tap complete
+
+    bool tvalid;
+    cdataout_vec_t<ssr> tdata;
+    sample_index_t sample_index;
+    // the overflow flag of IQ_TDM is a register of ssr_multistage_decimator_mon
+    bool iq_overflow;
+    decimator_taps(tvalid_i, tdata_i, phase_reset_i, tvalid_tap, tdata_tap, sync_tap, iq_overflow);
+    select_tap(dec_factor, tvalid_tap, tdata_tap, tvalid, tdata);
+    // marker of the output word of the phase reset (the sample index is meaningless before the first phase reset)
+    bool sync = select_sync(dec_factor, sync_tap);
+    sample_counter(dec_factor, tvalid, sync, sample_index);
+
+    // block of output samples being filled: lanes 0 .. fill - 1 hold the samples of the previous output words
+    static cdataout_vec_t<ssr> block;
+    static ap_uint<4> fill = 0;
+    static sample_index_t block_index = 0;
+
+    // valid lanes of the output word
+    ap_uint<4> lanes = (dec_factor < ssr) ? ap_uint<4>(int(ssr) / dec_factor.to_int()) : ap_uint<4>(1);
+
+    cdataout_vec_t<ssr> block_next = block;
+    ap_uint<4> fill_next = fill;
+    if (tvalid)
+    {
+        // the word of the phase reset (and a word that does not fit after a change of dec_factor) starts a new block
+        ap_uint<4> start = (sync || fill + lanes > ssr) ? ap_uint<4>(0) : fill;
+        for (int i = 0; i < ssr; ++i)
+        {
+#pragma HLS UNROLL
+            if (i >= start && i < start + lanes)
+            {
+                block_next.re[i] = tdata.re[i - start.to_int()];
+                block_next.im[i] = tdata.im[i - start.to_int()];
+            }
+        }
+        if (start == 0)
+        {
+            block_index = sample_index;
+        }
+        fill_next = start + lanes;
+    }
+
+    tvalid_o = (fill_next == ssr);
+    bfp_compress<bfp_mant_bits>(block_next, tdata_o);
+    sample_index_o = block_index;
+    block = block_next;
+    fill = tvalid_o ? ap_uint<4>(0) : fill_next;
+}
+
+/**
+ * @brief Multistage decimator or polyphase filter bank channelizer, selected by chan_mode.
+ *
+ * With chan_mode set, the input band is split into pfb_channels channels of fs / pfb_channels (see pfb_channelizer.h):
+ * every valid input word gives one output word, the output word q of a block carries the channels
+ * q + k1 pfb_channels / ssr on lane k1. The sample index advances by ssr per output word: index / pfb_channels is
+ * the block (channel sample) and (index % pfb_channels) / ssr the word q. The decimator and the channelizer run in
+ * parallel on the same input and share the phase reset, chan_mode selects the output (quasi-static).
+ *
+ * @param dec_factor The decimation factor to be applied (decimator mode).
+ * @param chan_mode Select the channelizer output.
+ * @param tvalid_i The validity flag of the input data.
+ * @param tdata_i The input data vector.
+ * @param phase_reset_i Reset the decimation phase and start a channelizer block, rising edge (see decimator_taps).
+ * @param tvalid_o The validity flag of the output data.
+ * @param tdata_o The output data vector.
+ * @param sample_index_o Index of the input sample of lane 0 of the output word (see sample_counter).
+ */
+void ssr_multistage_decimator_pfb(dec_factor_t dec_factor, bool chan_mode, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o,
+                                  sample_index_t &sample_index_o)
+{
+    bool tvalid_tap[num_taps];
+    cdataout_vec_t<ssr> tdata_tap[num_taps];
+    bool sync_tap[num_taps];
+#pragma HLS ARRAY_PARTITION variable = tvalid_tap complete
+#pragma HLS ARRAY_PARTITION variable = tdata_tap complete
+#pragma HLS ARRAY_PARTITION variable = sync_tap complete
+
+    // the overflow flag of IQ_TDM is a register of ssr_multistage_decimator_mon
+    bool iq_overflow;
+    decimator_taps(tvalid_i, tdata_i, phase_reset_i, tvalid_tap, tdata_tap, sync_tap, iq_overflow);
+
+    bool tvalid_dec;
+    cdataout_vec_t<ssr> tdata_dec;
+    select_tap(dec_factor, tvalid_tap, tdata_tap, tvalid_dec, tdata_dec);
+
+    bool tvalid_pfb;
+    cdataout_vec_t<ssr> tdata_pfb;
+    bool sync_pfb;
+    pfb_channelizer(tvalid_i, tdata_i, sync_tap[0], tvalid_pfb, tdata_pfb, sync_pfb);
+
+    tvalid_o = chan_mode ? tvalid_pfb : tvalid_dec;
+    tdata_o = chan_mode ? tdata_pfb : tdata_dec;
+    // one output word per input word in channelizer mode
+    sample_counter(chan_mode ? dec_factor_t(1) : dec_factor, tvalid_o, chan_mode ? sync_pfb : select_sync(dec_factor, sync_tap), sample_index_o);
+}
+
+/**
+ * @brief read the first N lanes of the interpolator input word
+ *
+ */
+template <int N>
+cdata_vec_t<N> read_lanes(cdata_vec_t<ssr> tdata_i)
+{
+    cdata_vec_t<N> tdata_o;
+    for (int i = 0; i < N; ++i) {
+    #pragma HLS UNROLL
+        tdata_o.re[i] = tdata_i.re[i];
+        tdata_o.im[i] = tdata_i.im[i];
+    }
+    return tdata_o;
+}
+
+/**
+ * @brief Multistage interpolator (transmit path): the inverse of the multistage decimator.
+ *
+ * The input at 1280 / int_factor MSPS is interpolated to 1280 MSPS, 8 output samples per clock cycle at 160 MHz,
+ * with the half-band stages of the decimator in reverse order (see int_filters.h). The input word carries
+ * 8 / int_factor samples on the first lanes (int_factor <= 8) or one sample on lane 0 (int_factor >= 16), the format
+ * of the decimator output. The input word enters the stage of the selected factor, the upstream stages are idle.
+ *
+ * The output rate is fixed, so the interpolator sets the input schedule: tready_o requests an input word every
+ * clock cycle up to int_factor 8, and every int_factor / 8 clock cycles above (AXI4-Stream: the word is taken when
+ * tvalid_i and tready_o are both set). On an underrun (tvalid_i low on a requested cycle) a zero word is inserted,
+ * so the output stays continuous.
+ *
+ * @param int_factor The interpolation factor (1, 2, 4, ..., 64).
+ * @param tvalid_i The validity flag of the input data.
+ * @param tdata_i The input data vector.
+ * @param tready_o Input word request.
+ * @param tvalid_o The validity flag of the output data (set every clock cycle once the stages are filled).
+ * @param tdata_o The output data vector.
+ */
+void ssr_multistage_interpolator(int_factor_t int_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool &tready_o, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o)
+{
+    // ----------------------------------------------------
+    // input schedule
+    // ----------------------------------------------------
+    static ap_uint<3> slot = 0;
+    ap_uint<3> slot_mask = (int_factor > ssr) ? ap_uint<3>(int_factor.to_int() / int(ssr) - 1) : ap_uint<3>(0);
+    bool tready = ((slot & slot_mask) == 0);
+    slot = slot + 1;
+    tready_o = tready;
+
+    // input word, zero on underrun
+    cdata_vec_t<ssr> tdata_v;
+    for (int i = 0; i < ssr; ++i) {
+    #pragma HLS UNROLL
+        tdata_v.re[i] = tvalid_i ? data_t(tdata_i.re[i]) : data_t(0);
+        tdata_v.im[i] = tvalid_i ? data_t(tdata_i.im[i]) : data_t(0);
+    }
+
+    // ----------------------------------------------------
+    // single-rate stages (interpolation factor = 64, 32, 16)
+    // ----------------------------------------------------
+    bool tvalid_int64;
+    cdata_vec_t<1> tdata_int64;
+    int2_ssr1<64>(tready && int_factor == 64, read_lanes<1>(tdata_v), tvalid_int64, tdata_int64);
+
+    bool tvalid_int32;
+    cdata_vec_t<1> tdata_int32;
+    bool tvalid_i_int32 = (int_factor == 32) ? tready : tvalid_int64;
+    int2_ssr1<32>(tvalid_i_int32, (int_factor == 32) ? read_lanes<1>(tdata_v) : tdata_int64, tvalid_int32, tdata_int32);
+
+    bool tvalid_int16;
+    cdata_vec_t<1> tdata_int16;
+    bool tvalid_i_int16 = (int_factor == 16) ? tready : tvalid_int32;
+    int2_ssr1<16>(tvalid_i_int16, (int_factor == 16) ? read_lanes<1>(tdata_v) : tdata_int32, tvalid_int16, tdata_int16);
+
+    // ----------------------------------------------------
+    // SSR stages (interpolation factor = 8, 4, 2)
+    // ----------------------------------------------------
+    bool tvalid_int8;
+    cdata_vec_t<2> tdata_int8;
+    bool tvalid_i_int8 = (int_factor == 8) ? tready : tvalid_int16;
+    int2_ssr2(tvalid_i_int8, (int_factor == 8) ? read_lanes<1>(tdata_v) : tdata_int16, tvalid_int8, tdata_int8);
+
+    bool tvalid_int4;
+    cdata_vec_t<4> tdata_int4;
+    bool tvalid_i_int4 = (int_factor == 4) ? tready : tvalid_int8;
+    int2_ssr4(tvalid_i_int4, (int_factor == 4) ? read_lanes<2>(tdata_v) : tdata_int8, tvalid_int4, tdata_int4);
+
+    bool tvalid_int2;
+    cdata_vec_t<8> tdata_int2;
+    bool tvalid_i_int2 = (int_factor == 2) ? tready : tvalid_int4;
+    int2_ssr8(tvalid_i_int2, (int_factor == 2) ? read_lanes<4>(tdata_v) : tdata_int4, tvalid_int2, tdata_int2);
+
+    // ----------------------------------------------------
+    // output: by-pass (interpolation factor = 1) or last stage
+    // ----------------------------------------------------
+    tvalid_o = (int_factor == 1) ? tready : tvalid_int2;
+    tdata_o = copy_data<8>((int_factor == 1) ? tdata_v : tdata_int2);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Dataflow version of the multistage decimator
+//
+// Each decimation stage is a free-running process, the stages are connected by streams.
+// Every stage writes its output to the next stage and to the output selector (tap stream),
+// the output selector drains all the tap streams and forwards the one selected by dec_factor.
+// The phase reset marker travels with the data: every stream word carries the sync flag of its first sample.
+// The initiation interval of each process is set in run.tcl according to its input sample rate,
+// so the lower-rate stages can share the multipliers.
+// In the per-stage flow (run_stage.tcl), the SSR stages can also run in a faster clock domain (StagePump).
+// ---------------------------------------------------------------------------------------------
+
+/**
+ * @brief stream word between the processes: data vector and phase reset marker (see decimator_taps)
+ */
+template <typename T>
+struct df_word_t
+{
+    T tdata;
+    bool sync;
+};
+
+/**
+ * @brief zero data vector: input of a free-running stage when its input stream is empty (tvalid low)
+ */
+template <typename T, int N>
+T df_zero()
+{
+    T tdata;
+    for (int i = 0; i < N; ++i) {
+    #pragma HLS UNROLL
+        tdata.re[i] = 0;
+        tdata.im[i] = 0;
+    }
+    return tdata;
+}
+
+/**
+ * @brief read a stream word without blocking, a zero word with no marker when the stream is empty
+ */
+template <typename T, int N>
+bool df_read(hls::stream<df_word_t<T>> &word_i, T &tdata, bool &sync)
+{
+    df_word_t<T> word;
+    bool tvalid = word_i.read_nb(word);
+    tdata = tvalid ? word.tdata : df_zero<T, N>();
+    sync = tvalid && word.sync;
+    return tvalid;
+}
+
+/**
+ * @brief input process: attach the phase reset marker to the input words, split them to the first stage and to the by-pass tap
+ */
+void df_input(hls::stream<cdatain_vec_t<ssr>> &tdata_i, hls::stream<bool> &phase_reset_i, hls::stream<df_word_t<cdatain_vec_t<ssr>>> &tdata_o,
+              hls::stream<df_word_t<cdatain_vec_t<ssr>>> &tap_o)
+{
+    df_word_t<cdatain_vec_t<ssr>> word;
+    word.tdata = df_zero<cdatain_vec_t<ssr>, ssr>();
+    if (tdata_i.read_nb(word.tdata)) {
+        // one marker per input word
+        word.sync = phase_reset_i.read();
+        tdata_o.write(word);
+        tap_o.write(word);
+    }
+}
+
+/**
+ * @brief first filter stage (decimation factor = 2)
+ */
+void df_dec2_ssr8(hls::stream<df_word_t<cdatain_vec_t<ssr>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<4>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<4>>> &tap_o)
+{
+    cdatain_vec_t<ssr> tdata;
+    bool sync;
+    bool tvalid = df_read<cdatain_vec_t<ssr>, ssr>(tdata_i, tdata, sync);
+
+    bool tvalid_dec2;
+    cdata_vec_t<8> tdata_o_dec2;
+    bool phase_reset_dec2;
+    dec2_ssr8(tvalid, tdata, sync, tvalid_dec2, tdata_o_dec2, phase_reset_dec2);
+
+    if (tvalid_dec2) {
+        df_word_t<cdata_vec_t<4>> word = {read_data<4>(tdata_o_dec2), phase_reset_dec2};
+        tdata_o.write(word);
+        tap_o.write(word);
+    }
+}
+
+/**
+ * @brief second filter stage (decimation factor = 4)
+ */
+void df_dec2_ssr4(hls::stream<df_word_t<cdata_vec_t<4>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<2>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<2>>> &tap_o)
+{
+    cdata_vec_t<4> tdata;
+    bool sync;
+    bool tvalid = df_read<cdata_vec_t<4>, 4>(tdata_i, tdata, sync);
+
+    bool tvalid_dec4;
+    cdata_vec_t<4> tdata_o_dec4;
+    bool phase_reset_dec4;
+    dec2_ssr4(tvalid, tdata, sync, tvalid_dec4, tdata_o_dec4, phase_reset_dec4);
+
+    if (tvalid_dec4) {
+        df_word_t<cdata_vec_t<2>> word = {read_data<2>(tdata_o_dec4), phase_reset_dec4};
+        tdata_o.write(word);
+        tap_o.write(word);
+    }
+}
+
+/**
+ * @brief third filter stage (decimation factor = 8)
+ */
+void df_dec2_ssr2(hls::stream<df_word_t<cdata_vec_t<2>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<1>>> &tap_o)
+{
+    cdata_vec_t<2> tdata;
+    bool sync;
+    bool tvalid = df_read<cdata_vec_t<2>, 2>(tdata_i, tdata, sync);
+
+    bool tvalid_dec8;
+    cdata_vec_t<2> tdata_o_dec8;
+    bool phase_reset_dec8;
+    dec2_ssr2(tvalid, tdata, sync, tvalid_dec8, tdata_o_dec8, phase_reset_dec8);
+
+    if (tvalid_dec8) {
+        df_word_t<cdata_vec_t<1>> word = {read_data<1>(tdata_o_dec8), phase_reset_dec8};
+        tdata_o.write(word);
+        tap_o.write(word);
+    }
+}
+
+/**
+ * @brief single-rate filter stage (decimation factor = 16, 32, 64)
+ */
+template <int instance_id>
+void df_dec2_ssr1(hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<1>>> &tap_o)
+{
+#pragma HLS INLINE recursive
+
+    cdata_vec_t<1> tdata;
+    bool sync;
+    bool tvalid = df_read<cdata_vec_t<1>, 1>(tdata_i, tdata, sync);
+
+    bool tvalid_dec;
+    df_word_t<cdata_vec_t<1>> word;
+    dec2_ssr1<instance_id>(tvalid, tdata, sync, tvalid_dec, word.tdata, word.sync);
+
+    if (tvalid_dec) {
+        tdata_o.write(word);
+        tap_o.write(word);
+    }
+}
+
+// the single-rate stages are wrapped in non-template functions, so that each process can be configured in run.tcl
+void df_dec16(hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<1>>> &tap_o)
+{
+    df_dec2_ssr1<16>(tdata_i, tdata_o, tap_o);
+}
+
+void df_dec32(hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_o, hls::stream<df_word_t<cdata_vec_t<1>>> &tap_o)
+{
+    df_dec2_ssr1<32>(tdata_i, tdata_o, tap_o);
+}
+
+/**
+ * @brief last filter stage (decimation factor = 64) - output to the tap only
+ */
+void df_dec64(hls::stream<df_word_t<cdata_vec_t<1>>> &tdata_i, hls::stream<df_word_t<cdata_vec_t<1>>> &tap_o)
+{
+    cdata_vec_t<1> tdata;
+    bool sync;
+    bool tvalid = df_read<cdata_vec_t<1>, 1>(tdata_i, tdata, sync);
+
+    bool tvalid_dec64;
+    df_word_t<cdata_vec_t<1>> word;
+    dec2_ssr1<64>(tvalid, tdata, sync, tvalid_dec64, word.tdata, word.sync);
+
+    if (tvalid_dec64) {
+        tap_o.write(word);
+    }
+}
+
+/**
+ * @brief output selector: drain all the tap streams and forward the one selected by the decimation factor,
+ *        with the sample index of the output word (see sample_counter)
+ */
+void df_output(dec_factor_t dec_factor,
+               hls::stream<df_word_t<cdatain_vec_t<ssr>>> &tap_dec1,
+               hls::stream<df_word_t<cdata_vec_t<4>>> &tap_dec2,
+               hls::stream<df_word_t<cdata_vec_t<2>>> &tap_dec4,
+               hls::stream<df_word_t<cdata_vec_t<1>>> &tap_dec8,
+               hls::stream<df_word_t<cdata_vec_t<1>>> &tap_dec16,
+               hls::stream<df_word_t<cdata_vec_t<1>>> &tap_dec32,
+               hls::stream<df_word_t<cdata_vec_t<1>>> &tap_dec64,
+               hls::stream<cdataout_vec_t<ssr>> &tdata_o,
+               hls::stream<sample_index_t> &sample_index_o)
+{
+    cdatain_vec_t<ssr> tdata_dec1;
+    cdata_vec_t<4> tdata_dec2;
+    cdata_vec_t<2> tdata_dec4;
+    cdata_vec_t<1> tdata_dec8;
+    cdata_vec_t<1> tdata_dec16;
+    cdata_vec_t<1> tdata_dec32;
+    cdata_vec_t<1> tdata_dec64;
+    bool sync_tap[num_taps];
+#pragma HLS ARRAY_PARTITION variable = sync_tap complete
+
+    bool tvalid_dec1 = df_read<cdatain_vec_t<ssr>, ssr>(tap_dec1, tdata_dec1, sync_tap[0]);
+    bool tvalid_dec2 = df_read<cdata_vec_t<4>, 4>(tap_dec2, tdata_dec2, sync_tap[1]);
+    bool tvalid_dec4 = df_read<cdata_vec_t<2>, 2>(tap_dec4, tdata_dec4, sync_tap[2]);
+    bool tvalid_dec8 = df_read<cdata_vec_t<1>, 1>(tap_dec8, tdata_dec8, sync_tap[3]);
+    bool tvalid_dec16 = df_read<cdata_vec_t<1>, 1>(tap_dec16, tdata_dec16, sync_tap[4]);
+    bool tvalid_dec32 = df_read<cdata_vec_t<1>, 1>(tap_dec32, tdata_dec32, sync_tap[5]);
+    bool tvalid_dec64 = df_read<cdata_vec_t<1>, 1>(tap_dec64, tdata_dec64, sync_tap[6]);
+
+    bool tvalid = true;
+    cdataout_vec_t<ssr> tdata;
+    if (dec_factor == 1 && tvalid_dec1) {
+        tdata = copy_data(tdata_dec1);
+    } else if (dec_factor == 2 && tvalid_dec2) {
+        tdata = copy_data<4>(tdata_dec2);
+    } else if (dec_factor == 4 && tvalid_dec4) {
+        tdata = copy_data<2>(tdata_dec4);
+    } else if (dec_factor == 8 && tvalid_dec8) {
+        tdata = copy_data<1>(tdata_dec8);
+    } else if (dec_factor == 16 && tvalid_dec16) {
+        tdata = copy_data<1>(tdata_dec16);
+    } else if (dec_factor == 32 && tvalid_dec32) {
+        tdata = copy_data<1>(tdata_dec32);
+    } else if (dec_factor == 64 && tvalid_dec64) {
+        tdata = copy_data<1>(tdata_dec64);
+    } else {
+        tvalid = false;
+    }
+
+    if (tvalid) {
+        sample_index_t sample_index;
+        sample_counter(dec_factor, true, select_sync(dec_factor, sync_tap), sample_index);
+        tdata_o.write(tdata);
+        sample_index_o.write(sample_index);
+    }
+}
+
+/**
+ * @brief Performs multistage decimation on the input stream - dataflow version.
+ *
+ * Same processing and sideband as ssr_multistage_decimator, the valid flags are replaced by the streams:
+ * an output block is written to tdata_o, and its sample index to sample_index_o, for each valid output of the
+ * selected stage. phase_reset_i carries one flag per input word (as the TUSER of the input AXI4-Stream): a set flag
+ * marks the word that starts the decimation phase, i.e. the first valid word at or after the rising edge of the
+ * phase_reset_i port of the flat version.
+ *
+ * @param dec_factor The decimation factor to be applied.
+ * @param tdata_i The input data stream.
+ * @param phase_reset_i The phase reset marker of each input word (read with the word).
+ * @param tdata_o The output data stream.
+ * @param sample_index_o Index of the input sample of lane 0 of each output word (see sample_counter).
+ */
+void ssr_multistage_decimator_df(dec_factor_t dec_factor, hls::stream<cdatain_vec_t<ssr>> &tdata_i, hls::stream<bool> &phase_reset_i,
+                                 hls::stream<cdataout_vec_t<ssr>> &tdata_o, hls::stream<sample_index_t> &sample_index_o)
+{
+#pragma HLS DATAFLOW disable_start_propagation
+
+    // streams between the stages
+    hls::stream<df_word_t<cdatain_vec_t<ssr>>> tdata_dec2_i("tdata_dec2_i");
+    hls::stream<df_word_t<cdata_vec_t<4>>> tdata_dec4_i("tdata_dec4_i");
+    hls::stream<df_word_t<cdata_vec_t<2>>> tdata_dec8_i("tdata_dec8_i");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tdata_dec16_i("tdata_dec16_i");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tdata_dec32_i("tdata_dec32_i");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tdata_dec64_i("tdata_dec64_i");
+#pragma HLS STREAM variable = tdata_dec2_i depth = 2
+#pragma HLS STREAM variable = tdata_dec4_i depth = 2
+#pragma HLS STREAM variable = tdata_dec8_i depth = 2
+#pragma HLS STREAM variable = tdata_dec16_i depth = 4
+#pragma HLS STREAM variable = tdata_dec32_i depth = 4
+#pragma HLS STREAM variable = tdata_dec64_i depth = 4
+
+    // streams from each stage to the output selector
+    hls::stream<df_word_t<cdatain_vec_t<ssr>>> tap_dec1("tap_dec1");
+    hls::stream<df_word_t<cdata_vec_t<4>>> tap_dec2("tap_dec2");
+    hls::stream<df_word_t<cdata_vec_t<2>>> tap_dec4("tap_dec4");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tap_dec8("tap_dec8");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tap_dec16("tap_dec16");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tap_dec32("tap_dec32");
+    hls::stream<df_word_t<cdata_vec_t<1>>> tap_dec64("tap_dec64");
+#pragma HLS STREAM variable = tap_dec1 depth = 2
+#pragma HLS STREAM variable = tap_dec2 depth = 2
+#pragma HLS STREAM variable = tap_dec4 depth = 2
+#pragma HLS STREAM variable = tap_dec8 depth = 2
+#pragma HLS STREAM variable = tap_dec16 depth = 2
+#pragma HLS STREAM variable = tap_dec32 depth = 2
+#pragma HLS STREAM variable = tap_dec64 depth = 2
+
+    df_input(tdata_i, phase_reset_i, tdata_dec2_i, tap_dec1);
+    df_dec2_ssr8(tdata_dec2_i, tdata_dec4_i, tap_dec2);
+    df_dec2_ssr4(tdata_dec4_i, tdata_dec8_i, tap_dec4);
+    df_dec2_ssr2(tdata_dec8_i, tdata_dec16_i, tap_dec8);
+    df_dec16(tdata_dec16_i, tdata_dec32_i, tap_dec16);
+    df_dec32(tdata_dec32_i, tdata_dec64_i, tap_dec32);
+    df_dec64(tdata_dec64_i, tap_dec64);
+    df_output(dec_factor, tap_dec1, tap_dec2, tap_dec4, tap_dec8, tap_dec16, tap_dec32, tap_dec64, tdata_o, sample_index_o);
+}
@@ -15,6 +15,7 @@
 
 #include "ap_fixed.h"
 #include "ap_int.h"
+#include "hls_stream.h"
 
 // C++ class (ap_shift_reg) to ensure that the shift register defined in the C code is always implemented using an SRL resource
 #include "ap_shift_reg.h"
@@ -23,11 +24,56 @@
 
 // decimation factor data type:
 typedef ap_uint<8> dec_factor_t;
+// interpolation factor data type (ssr_multistage_interpolator):
+typedef ap_uint<8> int_factor_t;
+
+// worst-case growth of a filter (coefficients in units of the coefficient lsb):
+// sum of the absolute values of the coefficients
+constexpr long long coef_abs_sum(const int *coef, int num_coef)
+{
+    long long sum = 0;
+    for (int i = 0; i < num_coef; ++i)
+    {
+        sum += (coef[i] < 0) ? -coef[i] : coef[i];
+    }
+    return sum;
+}
+
+// largest absolute value of the coefficients
+constexpr long long coef_abs_max(const int *coef, int num_coef)
+{
+    long long max = 0;
+    for (int i = 0; i < num_coef; ++i)
+    {
+        long long abs = (coef[i] < 0) ? -coef[i] : coef[i];
+        max = (abs > max) ? abs : max;
+    }
+    return max;
+}
+
+// integer bits (sign included) of a signed fixed point type holding the values of magnitude up to value x 2^-fractional_bits
+constexpr int signed_integer_bits(long long value, int fractional_bits)
+{
+    int bits = 1;
+    while ((1LL << (bits - 1 + fractional_bits)) <= value)
+    {
+        ++bits;
+    }
+    return bits;
+}
 
 // fixed point data type:
-constexpr int coef_bits = 18;
-constexpr int coef_fractional_bits = 17;
+// coefficient word length (18, 24 or 27 bits), set at compile time (-DCOEF_BITS=...)
+// 18 bits fit the B port of DSP48E2, 24 and 27 bits fit the multiplier ports of DSP58 (Versal)
+#ifndef COEF_BITS
+#define COEF_BITS 18
+#endif
+constexpr int coef_bits = COEF_BITS;
+constexpr int coef_fractional_bits = coef_bits - 1;
 constexpr int coef_integer_bits = coef_bits - coef_fractional_bits;
+static_assert(coef_bits == 18 || coef_bits == 24 || coef_bits == 27, "COEF_BITS must be 18, 24 or 27");
+// prototype filter coefficients of the selected word length (hbf_coef)
+#include "hbf_coefs.h"
 //
 constexpr int datain_bits = 16;
 constexpr int datain_fractional_bits = 15;
@@ -37,17 +83,60 @@ constexpr int data_bits = 16;
 constexpr int data_fractional_bits = 15;
 constexpr int data_integer_bits = data_bits - data_fractional_bits;
 //
-constexpr int dataout_bits = 16;
-constexpr int dataout_fractional_bits = 15;
+// output word length (16, 12 or 8 bits), set at compile time (-DDATAOUT_BITS=...)
+// the output samples are rounded (AP_RND_INF) and saturated (AP_SAT) to dataout_bits, and packed on the output bus
+#ifndef DATAOUT_BITS
+#define DATAOUT_BITS 16
+#endif
+constexpr int dataout_bits = DATAOUT_BITS;
+constexpr int dataout_fractional_bits = dataout_bits - 1;
 constexpr int dataout_integer_bits = dataout_bits - dataout_fractional_bits;
+static_assert(dataout_bits == 16 || dataout_bits == 12 || dataout_bits == 8, "DATAOUT_BITS must be 16, 12 or 8");
+
+// fs/4 frequency shift at the input of dec2_ssr8 (DEC2_FS4_SHIFT) and dec2_ssr4 (DEC4_FS4_SHIFT), set at compile time:
+//  0: no shift, +1: shift by +fs/4 (selects the band centred at -fs/4), -1: shift by -fs/4 (selects the band centred at +fs/4)
+// fs is the input sample rate of the stage (1280 MHz for dec2_ssr8, 640 MHz for dec2_ssr4)
+#ifndef DEC2_FS4_SHIFT
+#define DEC2_FS4_SHIFT 0
+#endif
+#ifndef DEC4_FS4_SHIFT
+#define DEC4_FS4_SHIFT 0
+#endif
+constexpr int dec2_fs4_shift = DEC2_FS4_SHIFT;
+constexpr int dec4_fs4_shift = DEC4_FS4_SHIFT;
+static_assert(dec2_fs4_shift >= -1 && dec2_fs4_shift <= 1, "DEC2_FS4_SHIFT must be 0, 1 or -1");
+static_assert(dec4_fs4_shift >= -1 && dec4_fs4_shift <= 1, "DEC4_FS4_SHIFT must be 0, 1 or -1");
 
 typedef ap_int<coef_bits> coef_int_t;                                               // integer type to load coefficients from file
-typedef ap_fixed<coef_bits, coef_integer_bits> coef_t;                              // coef is s18.17
+typedef ap_fixed<coef_bits, coef_integer_bits> coef_t;                              // coef is s18.17 (s24.23, s27.26)
 typedef ap_fixed<datain_bits, datain_integer_bits> datain_t;                        // data is s16.15
 typedef ap_fixed<data_bits, data_integer_bits> data_t;                              // data is s16.15
-typedef ap_fixed<34, 34 - 32> mult_t;                                   // s18.17 x s16.15 = s34.32
-typedef ap_fixed<40, 40 - 32> acc_t;                                    // 
-typedef ap_fixed<dataout_bits, dataout_integer_bits, AP_RND_INF, AP_SAT> dataout_t; // s16.15
+typedef ap_fixed<data_bits, data_integer_bits, AP_TRN, AP_SAT> data_sat_t;          // data is s16.15, saturated (negation of -1.0)
+// product and accumulator widths, derived at compile time from the prototype coefficients (data in [-1, 1)):
+// - product:     |h x| <= max |h|
+// - accumulator: every stage computes the prototype filter (the polyphase branches partition its taps and the
+//                phase combiner adds them), so every partial sum of a stage is bounded by sum |h|
+constexpr int mult_fractional_bits = coef_fractional_bits + data_fractional_bits;
+constexpr int mult_integer_bits = signed_integer_bits(coef_abs_max(hbf_coef, hbf_num_taps), coef_fractional_bits);
+constexpr int mult_bits = mult_integer_bits + mult_fractional_bits;
+constexpr int acc_integer_bits = signed_integer_bits(coef_abs_sum(hbf_coef, hbf_num_taps), coef_fractional_bits);
+constexpr int acc_bits = acc_integer_bits + mult_fractional_bits;
+static_assert(acc_integer_bits >= data_integer_bits, "the accumulator must hold the stage output");
+typedef ap_fixed<mult_bits, mult_integer_bits> mult_t;                             // s18.17 x s16.15 = s33.32 (max |h| = 0.5)
+typedef ap_fixed<acc_bits, acc_integer_bits> acc_t;                                // s34.32 (sum |h| = 1.54)
+typedef ap_fixed<acc_bits, acc_integer_bits + 1> int_acc_t;                        // acc_t x 2: interpolator stage output (zero stuffing)
+typedef ap_fixed<dataout_bits, dataout_integer_bits, AP_RND_INF, AP_SAT> dataout_t; // s16.15 (s12.11, s8.7)
+// fast FIR algorithm (FFA) sub-filters of the SSR stages (SSR_FFA, see dec_filters.h):
+// - data:        sum of up to 4 input samples
+// - coefficient: sum of up to 4 polyphase components, any sum of prototype coefficients is bounded by sum |h|
+// - accumulator: the sub-filter outputs are bounded by 4 sum |h|, the post-additions restore the stage output
+constexpr int ffa_data_integer_bits = data_integer_bits + 2;
+constexpr int ffa_coef_integer_bits = acc_integer_bits;
+constexpr int ffa_acc_integer_bits = acc_integer_bits + 2;
+typedef ap_int<ffa_coef_integer_bits + coef_fractional_bits> ffa_coef_int_t;                          // s19.17 (s25.23, s28.26)
+typedef ap_fixed<ffa_coef_integer_bits + coef_fractional_bits, ffa_coef_integer_bits> ffa_coef_t;    // s19.17 (s25.23, s28.26)
+typedef ap_fixed<ffa_data_integer_bits + data_fractional_bits, ffa_data_integer_bits> ffa_data_t;    // s18.15
+typedef ap_fixed<ffa_acc_integer_bits + mult_fractional_bits, ffa_acc_integer_bits> ffa_acc_t;       // s36.32
 typedef ap_uint<8> coef_addr_t;
 
 // Define a complex number struct
@@ -75,6 +164,18 @@ typedef struct
     acc_t im;
 } cacc_t;
 
+typedef struct
+{
+    ffa_data_t re;
+    ffa_data_t im;
+} cffa_data_t;
+
+typedef struct
+{
+    ffa_acc_t re;
+    ffa_acc_t im;
+} cffa_acc_t;
+
 template <std::size_t N>
 struct cdatain_vec_t
 {
@@ -100,7 +201,83 @@ struct cdataout_vec_t
 // Super-Sample Rate => Parallelism Factor - or Hardware Oversampling Rate
 const std::size_t ssr = 8;
 
+// tap points: output of each stage, in the format of the output port (0: input/by-pass, 1: dec2, ..., 6: dec64)
+constexpr int num_taps = 7;
+
+// snapshot capture buffer: number of output words (set at compile time, -DSNAPSHOT_DEPTH=...)
+#ifndef SNAPSHOT_DEPTH
+#define SNAPSHOT_DEPTH 1024
+#endif
+constexpr int snapshot_depth = SNAPSHOT_DEPTH;
+static_assert(snapshot_depth * ssr <= 65536, "SNAPSHOT_DEPTH too large for the read address register");
+typedef ap_uint<3> snapshot_tap_t;   // tap point to be captured
+typedef ap_uint<16> snapshot_len_t;  // number of words to be captured
+typedef ap_uint<16> snapshot_addr_t; // read address: word * ssr + lane
+typedef ap_uint<32> axil_reg_t;      // AXI-Lite register
+
+// sample index sideband: index of the input sample of lane 0 of each output word, counted from the last sync
+// (48 bits: about 2.5 days at 1280 MHz before wrapping)
+typedef ap_uint<48> sample_index_t;
+
+// power meter (RSSI)
+typedef ap_uint<3> pwr_src_t;  // measured signal: 0 = output (selected by dec_factor), 1..7 = tap point 0..6
+typedef ap_uint<32> pwr_len_t; // integration length register (number of valid words, saturated to pwr_len_max)
+typedef ap_uint<64> pwr_acc_t; // sum of I^2 + Q^2
+// |I|^2 + |Q|^2 <= 2 x 2^30 = 2^31 per sample, so a word (8 lanes) is at most 2^34 and the sum of pwr_len_max
+// words is less than 2^34 x 2^30 = 2^64: the integration length is limited to 2^30 - 1 words
+constexpr int pwr_len_bits = 30;
+constexpr unsigned pwr_len_max = (1u << pwr_len_bits) - 1;
+static_assert(pwr_len_bits + 2 * dataout_bits + 2 <= 64, "the power accumulator overflows");
+
+// block floating point (BFP) output: mantissa bits (8, 10 or 12), set at compile time (-DBFP_MANTISSA_BITS=...)
+#ifndef BFP_MANTISSA_BITS
+#define BFP_MANTISSA_BITS 8
+#endif
+constexpr int bfp_mant_bits = BFP_MANTISSA_BITS;
+constexpr int bfp_exp_bits = 8; // exponent field (byte aligned output block)
+static_assert(bfp_mant_bits == 8 || bfp_mant_bits == 10 || bfp_mant_bits == 12, "BFP_MANTISSA_BITS must be 8, 10 or 12");
+
+// BFP block: ssr complex samples sharing one exponent, sample = mantissa * 2^exp (in units of the dataout_t lsb)
+template <int mant_bits>
+struct bfp_block_t
+{
+    ap_uint<bfp_exp_bits> exp;
+    ap_int<mant_bits> re[ssr];
+    ap_int<mant_bits> im[ssr];
+};
+
+// polyphase filter bank channelizer (ssr_multistage_decimator_pfb): number of channels (16 or 32), set at compile time
+// (-DPFB_CHANNELS=...), each channel is fs / PFB_CHANNELS wide (80 or 40 MHz at 1280 MHz)
+#ifndef PFB_CHANNELS
+#define PFB_CHANNELS 16
+#endif
+constexpr int pfb_channels = PFB_CHANNELS;
+static_assert(pfb_channels == 16 || pfb_channels == 32, "PFB_CHANNELS must be 16 or 32");
+
 // top level function
-void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o);
+void ssr_multistage_decimator(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o,
+                              sample_index_t &sample_index_o);
+
+// top level function - dataflow version (each stage is a process, stages are connected by streams)
+void ssr_multistage_decimator_df(dec_factor_t dec_factor, hls::stream<cdatain_vec_t<ssr>> &tdata_i, hls::stream<bool> &phase_reset_i,
+                                 hls::stream<cdataout_vec_t<ssr>> &tdata_o, hls::stream<sample_index_t> &sample_index_o);
+
+// top level function - block floating point compressed output (valid samples packed into blocks of ssr samples)
+void ssr_multistage_decimator_bfp(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, bfp_block_t<bfp_mant_bits> &tdata_o,
+                                  sample_index_t &sample_index_o);
+
+// top level function - with monitoring functions (snapshot capture of any tap point, power meter, IQ_TDM overflow flag), controlled by AXI-Lite registers
+void ssr_multistage_decimator_mon(dec_factor_t dec_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o, sample_index_t &sample_index_o,
+                                  bool trigger_i, snapshot_tap_t snap_tap, snapshot_len_t snap_length, bool snap_arm, bool snap_force,
+                                  snapshot_addr_t snap_rd_addr, axil_reg_t &snap_rd_data, axil_reg_t &snap_status,
+                                  pwr_src_t pwr_src, pwr_len_t pwr_length, bool pwr_hold, pwr_acc_t &pwr_sum, axil_reg_t &pwr_count,
+                                  bool &iq_overflow);
+
+// top level function - multistage decimator or polyphase filter bank channelizer (pfb_channels channels), selected by chan_mode
+void ssr_multistage_decimator_pfb(dec_factor_t dec_factor, bool chan_mode, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool phase_reset_i, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o,
+                                  sample_index_t &sample_index_o);
+
+// top level function - multistage interpolator (transmit path), interpolation factor 1, 2, 4, ..., 64
+void ssr_multistage_interpolator(int_factor_t int_factor, bool tvalid_i, cdatain_vec_t<ssr> tdata_i, bool &tready_o, bool &tvalid_o, cdataout_vec_t<ssr> &tdata_o);
 
 #endif // SSR_MULTISTAGE_DECIMATOR
@@ -13,12 +13,30 @@
 #include <fstream>
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 
 #include "../src/ssr_multistage_decimator.h"
+#ifdef BFP_TOP
+#include "../../sw/src/bfp_decompress.h"
+#endif
+#if DATAOUT_BITS != 16
+#include "../../sw/src/packed_samples.h"
+#endif
+#ifdef PFB_TOP
+#include <cmath>
+#include <complex>
+#include "../src/pfb_coefs.h"
+#include "../src/delay_lines.h"
+#endif
+#ifdef INTERP_TOP
+#include <cmath>
+#include <complex>
+#endif
 
 // ANSI escape codes for setting text colors
 const std::string GREEN = "\033[32m";
@@ -33,15 +51,86 @@ struct dataInputInterface_t
 {
     bool tvalid;              // input data valid
     cdatain_vec_t<ssr> tdata; // input sample
+    bool phase_reset;         // reset the decimation phase
 };
 struct dataOutputInterface_t
 {
-    bool tvalid;               // data valid
-    cdataout_vec_t<ssr> tdata; // output samples
+    bool tvalid;                 // data valid
+    cdataout_vec_t<ssr> tdata;   // output samples
+    sample_index_t sample_index; // index of the input sample of lane 0
 };
 
+#ifdef MONITOR_TOP
+// snapshot capture registers of ssr_multistage_decimator_mon
+struct snapshotInterface_t
+{
+    bool trigger = false;
+    snapshot_tap_t tap = 0;
+    snapshot_len_t length = 0;
+    bool arm = false;
+    bool force = false;
+    snapshot_addr_t rd_addr = 0;
+    axil_reg_t rd_data = 0;
+    axil_reg_t status = 0;
+} snap;
+
+// power meter registers of ssr_multistage_decimator_mon
+struct powerMeterInterface_t
+{
+    pwr_src_t src = 0;
+    pwr_len_t length = 0;
+    bool hold = false;
+    pwr_acc_t sum = 0;
+    axil_reg_t count = 0;
+} pwr;
+
+// overflow flag of the IQ_TDM queues of ssr_multistage_decimator_mon
+bool iqOverflow = false;
+
+// power meter test: integration length of the output power (number of valid words)
+constexpr int powerMeterLength = 16;
+// the result registers are held from the output word powerHoldStart for powerHoldWords valid words (several dumps)
+constexpr int powerHoldStart = 40;
+constexpr int powerHoldWords = 3 * powerMeterLength + 5;
+
+// snapshot test: the output tap is captured starting from the input sample snapshotTriggerSample
+constexpr int snapshotTriggerSample = 800;
+constexpr int snapshotLength = 32;
+
+int checkSnapshot(const std::vector<cdataout_vec_t<ssr>> &expected, dec_factor_t dec_factor, const dataInputInterface_t &din, dataOutputInterface_t &dout);
+int checkIqOverflow(dec_factor_t dec_factor);
+#endif
+
+#ifndef PFB_TOP
+#include "../../sw/src/simd_decimator.h"
+
+// phase reset test: input word of the mid-stream phase reset (input sample 1896, not a multiple of the decimation
+// period above dec_factor 8)
+constexpr int phaseResetWord = 237;
+
+int checkPhaseReset(dec_factor_t dec_factor, const std::vector<cdatain_vec_t<ssr>> &input, const std::vector<cdataout_vec_t<ssr>> &output);
+
+// golden check: with the default output options, the C-simulation is compared with the reference vectors of the
+// default build (data/golden, see scripts/golden_vectors.py), e.g. to check that SSR_FFA and IQ_TDM do not change the output
+#if COEF_BITS == 18 && DATAOUT_BITS == 16 && DEC2_FS4_SHIFT == 0 && DEC4_FS4_SHIFT == 0 && !defined(BFP_TOP)
+#define GOLDEN_CHECK
+int checkGolden(dec_factor_t dec_factor);
+#endif
+#endif
+
+#ifdef INTERP_TOP
+int runInterpolator(int_factor_t int_factor, std::ifstream &inputFile, std::ofstream &outputFile);
+#endif
+
+#ifdef PFB_TOP
+int checkDelayLines();
+int checkChannelizer(const std::vector<cdatain_vec_t<ssr>> &input, const std::vector<cdataout_vec_t<ssr>> &output);
+#endif
+
 // Function prototype.
+void runDut(dec_factor_t dec_factor, const dataInputInterface_t &din, dataOutputInterface_t &dout);
 void readParameterFile(std::ifstream &parameterFile, dec_factor_t &dec_factor);
+bool readInputLine(std::ifstream &inputFile, std::string &line);
 // void parseInputLine(std::string &inputLine, dataInputInterface_t &din);
 void writeOutput(std::ofstream &outputFile, const dataOutputInterface_t &dout, const size_t ssr);
 
@@ -91,6 +180,20 @@ int main(void)
         return 1;
     }
 
+#ifdef INTERP_TOP
+    // the interpolator has its own stimulus and check (see runInterpolator), the parameter is the interpolation factor
+    int_factor_t int_factor = 1;
+    readParameterFile(parameterFile, int_factor);
+    return runInterpolator(int_factor, inputFile, outputFile);
+#endif
+#ifdef PFB_TOP
+    // storage policies of the tap-to-tap delay lines of the polyphase branches
+    if (checkDelayLines())
+    {
+        return 1;
+    }
+#endif
+
     // ----------------------------
     // Testbench variables
     // ----------------------------
@@ -103,6 +206,10 @@ int main(void)
     // number of clocks to wait before start sending the input samples
     int numClkWait = 10;
 
+    // expected sample index of the next output word (the phase reset marks the first input word)
+    uint64_t sampleIndexExpected = 0;
+    int sampleIndexErrors = 0;
+
     // ------------------------------------
     // ssr_multistage_decimator I/O ports
     // ------------------------------------
@@ -112,7 +219,8 @@ int main(void)
 
     struct dataInputInterface_t din = {
         .tvalid = false,
-        .tdata = {0xBBBB, 0xAAAA}};
+        .tdata = {0xBBBB, 0xAAAA},
+        .phase_reset = false};
 
     struct dataOutputInterface_t dout;
 
@@ -123,7 +231,7 @@ int main(void)
     for (int i = 0; i < numClkWait; ++i)
     {
         // logInput(logInputFile, dec_factor, din);
-        ssr_multistage_decimator(dec_factor, din.tvalid, din.tdata, dout.tvalid, dout.tdata);
+        runDut(dec_factor, din, dout);
         writeOutput(outputFile, dout, ssr);
     }
 
@@ -133,16 +241,53 @@ int main(void)
 
     // Read the parameters file
     readParameterFile(parameterFile, dec_factor);
+#ifdef MONITOR_TOP
+    // arm the snapshot capture of the selected output
+    for (int tap = 0; tap < num_taps; ++tap)
+    {
+        if (dec_factor == (1 << tap))
+            snap.tap = tap;
+    }
+    snap.length = snapshotLength;
+    snap.arm = true;
+    std::vector<cdataout_vec_t<ssr>> snapshotExpected;
+    bool snapshotTriggered = false;
+    // measure the output power
+    pwr.src = 0;
+    pwr.length = powerMeterLength;
+    pwr_acc_t powerExpected = 0;
+    pwr_acc_t powerLast = 0;
+    int powerWords = 0;
+    int powerOutputWords = 0;
+    int powerDumps = 0;
+    int powerHeldDumps = 0;
+    int powerErrors = 0;
+    axil_reg_t powerCount = pwr.count;
+    axil_reg_t powerHeldCount = pwr.count;
+    pwr_acc_t powerHeldSum = pwr.sum;
+#endif
+#ifdef PFB_TOP
+    // valid input words from the phase reset and valid output words of the channelizer
+    std::vector<cdatain_vec_t<ssr>> channelizerInput;
+    std::vector<cdataout_vec_t<ssr>> channelizerOutput;
+#else
+    // valid input and output words of the decimator (phase reset test)
+    std::vector<cdatain_vec_t<ssr>> decimatorInput;
+    std::vector<cdataout_vec_t<ssr>> decimatorOutput;
+#endif
     //
-    ssr_multistage_decimator(dec_factor, din.tvalid, din.tdata, dout.tvalid, dout.tdata);
+    runDut(dec_factor, din, dout);
     writeOutput(outputFile, dout, ssr);
 
     std::cout << "Waiting some more " << numClkWait << " clocks before sending data ..." << std::endl;
     for (int i = 0; i < numClkWait; ++i)
     {
-        ssr_multistage_decimator(dec_factor, din.tvalid, din.tdata, dout.tvalid, dout.tdata);
+        // align the decimation phase to the first input word (the pulse is applied to the next valid word)
+        din.phase_reset = (i == numClkWait - 1);
+        runDut(dec_factor, din, dout);
         writeOutput(outputFile, dout, ssr);
     }
+    din.phase_reset = false;
 
     // ------------------------------------
     // variables to control the simulation
@@ -165,7 +310,7 @@ int main(void)
     std::string line;
 
     // loop over the input test vector file
-    while ((std::getline(inputFile, line) || !tapDelayLineFlushed))
+    while ((readInputLine(inputFile, line) || !tapDelayLineFlushed))
     {
         if (!line.empty())
         {
@@ -188,19 +333,88 @@ int main(void)
         }
         else
         {
-            if (tapDelayLineCounter > 0)
-            {
-                tapDelayLineCounter--;
-            }
-            else
+            // idle cycles: gaps of the input stream, then the flush of the filters at the end of the input file
+            if (!inputFile)
             {
-                tapDelayLineFlushed = true;
+                if (tapDelayLineCounter > 0)
+                {
+                    tapDelayLineCounter--;
+                }
+                else
+                {
+                    tapDelayLineFlushed = true;
+                }
             }
             din.tvalid = false;
         }
 
+#ifdef MONITOR_TOP
+        snap.trigger = din.tvalid && (numInputSamples == snapshotTriggerSample);
+        pwr.hold = (powerOutputWords >= powerHoldStart) && (powerOutputWords < powerHoldStart + powerHoldWords);
+#endif
+
         // send data
-        ssr_multistage_decimator(dec_factor, din.tvalid, din.tdata, dout.tvalid, dout.tdata);
+        runDut(dec_factor, din, dout);
+
+#ifdef PFB_TOP
+        if (din.tvalid)
+        {
+            channelizerInput.push_back(din.tdata);
+        }
+        if (dout.tvalid)
+        {
+            channelizerOutput.push_back(dout.tdata);
+        }
+#else
+        if (din.tvalid)
+        {
+            decimatorInput.push_back(din.tdata);
+        }
+        if (dout.tvalid)
+        {
+            decimatorOutput.push_back(dout.tdata);
+        }
+#endif
+
+#ifdef MONITOR_TOP
+        // expected snapshot: the valid output words starting from the trigger
+        snapshotTriggered = snapshotTriggered || snap.trigger;
+        if (snapshotTriggered && dout.tvalid && snapshotExpected.size() < snapshotLength)
+        {
+            snapshotExpected.push_back(dout.tdata);
+        }
+
+        // expected power: integrate-and-dump of the output words
+        if (dout.tvalid)
+        {
+            for (size_t i = 0; i < ssr; ++i)
+            {
+                ap_int<dataout_bits> re = dout.tdata.re[i].range();
+                ap_int<dataout_bits> im = dout.tdata.im[i].range();
+                powerExpected += re * re + im * im;
+            }
+            if (++powerWords == powerMeterLength)
+            {
+                powerDumps++;
+                powerHeldDumps += pwr.hold;
+                powerLast = powerExpected;
+                powerExpected = 0;
+                powerWords = 0;
+            }
+            powerOutputWords++;
+        }
+        // the registers show the last completed period, and keep their value while held
+        if (pwr.hold)
+        {
+            powerErrors += (pwr.count != powerHeldCount) || (pwr.sum != powerHeldSum);
+        }
+        else
+        {
+            powerErrors += (pwr.count != powerCount + powerDumps) || (powerDumps > 0 && pwr.sum != powerLast);
+        }
+        powerHeldCount = pwr.count;
+        powerHeldSum = pwr.sum;
+#endif
 
 
 
@@ -208,7 +422,21 @@ int main(void)
         {
          
             //std::cout << "dout.tdata.re[0] = " << dout.tdata.re[0] << std::endl;
+            // sample index sideband: lane 0 of the output word is the input sample max(dec_factor, ssr) k
+            sampleIndexErrors += (dout.sample_index != sampleIndexExpected);
+#if defined(PFB_TOP)
+            // channelizer: one output word per input word
+            sampleIndexExpected += ssr;
+#elif defined(BFP_TOP)
+            // BFP: one block of ssr output samples
+            sampleIndexExpected += ssr * dec_factor.to_int();
+#else
+            sampleIndexExpected += (dec_factor < ssr) ? ssr : dec_factor.to_int();
+#endif
             // increment the number of output samples
+#if defined(PFB_TOP) || defined(BFP_TOP)
+            numOutputSamples = numOutputSamples + ssr;
+#else
             switch (dec_factor)
             {
             case 1:
@@ -229,6 +457,7 @@ int main(void)
             default:
                 break;
             }
+#endif
         }
         writeOutput(outputFile, dout, ssr);
     }
@@ -236,6 +465,69 @@ int main(void)
     // ---------------------------------
     // Simulation results
     // ---------------------------------
+    if (sampleIndexErrors)
+    {
+        std::cout << RED << "Sample index FAIL: " << sampleIndexErrors << " errors" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Sample index PASS: " << sampleIndexExpected << " input samples" << RESET << std::endl;
+#ifdef MONITOR_TOP
+    if (powerErrors || powerDumps == 0 || powerHeldDumps == 0)
+    {
+        std::cout << RED << "Power meter FAIL: " << powerErrors << " errors in " << powerDumps << " periods ("
+                  << powerHeldDumps << " held)" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Power meter PASS: " << powerDumps << " periods of " << powerMeterLength << " words ("
+              << powerHeldDumps << " held)" << RESET << std::endl;
+
+    din.tvalid = false;
+    snap.trigger = false;
+    if (checkSnapshot(snapshotExpected, dec_factor, din, dout))
+    {
+        return 1;
+    }
+#endif
+#ifdef PFB_TOP
+    if (checkChannelizer(channelizerInput, channelizerOutput))
+    {
+        return 1;
+    }
+#else
+    if (checkPhaseReset(dec_factor, decimatorInput, decimatorOutput))
+    {
+        return 1;
+    }
+#ifdef GOLDEN_CHECK
+    if (checkGolden(dec_factor))
+    {
+        return 1;
+    }
+#endif
+#endif
+#ifdef MONITOR_TOP
+    // last test: the overflow flag is sticky
+    if (checkIqOverflow(dec_factor))
+    {
+        return 1;
+    }
+#endif
+#ifdef BFP_TOP
+    // every output sample goes in a full block (the last partial block stays in the packer):
+    // 2 bfp_mant_bits + 1 bits per complex sample at every decimation factor
+    {
+        int numBlocks = numOutputSamples / ssr;
+        int expectedSamples = numInputSamples / dec_factor.to_int() / ssr * ssr;
+        double bitsPerSample = numOutputSamples ? 8.0 * bfp_block_bytes(bfp_mant_bits) * numBlocks / numOutputSamples : 0;
+        if (numOutputSamples != expectedSamples || bitsPerSample != 2 * bfp_mant_bits + 1)
+        {
+            std::cout << RED << "BFP FAIL: " << numOutputSamples << " samples (expected " << expectedSamples << "), "
+                      << bitsPerSample << " bits per sample" << RESET << std::endl;
+            return 1;
+        }
+        std::cout << GREEN << "BFP PASS: " << numBlocks << " blocks, " << bitsPerSample << " bits per sample" << RESET << std::endl;
+    }
+#endif
 
     std::cout << std::left; // Align all columns to the left
     // Print header with setw for alignment
@@ -251,6 +543,587 @@ int main(void)
     return 0;
 }
 
+// write a bits-wide field at bit offset pos of a little-endian bit stream (as packed on the output bus)
+void putBits(uint8_t *bytes, std::size_t &pos, uint32_t field, int bits)
+{
+    for (int b = 0; b < bits; ++b, ++pos)
+    {
+        bytes[pos / 8] |= ((field >> b) & 1) << (pos % 8);
+    }
+}
+
+#ifdef BFP_TOP
+// pack a BFP block as on the output bus (fields LSB first) into little-endian bytes
+void packBfpBlock(const bfp_block_t<bfp_mant_bits> &block, uint8_t *bytes)
+{
+    std::memset(bytes, 0, bfp_block_bytes(bfp_mant_bits));
+    std::size_t pos = 0;
+    putBits(bytes, pos, block.exp.to_int(), bfp_exp_bits);
+    for (size_t i = 0; i < ssr; ++i)
+        putBits(bytes, pos, static_cast<uint32_t>(block.re[i].to_int()), bfp_mant_bits);
+    for (size_t i = 0; i < ssr; ++i)
+        putBits(bytes, pos, static_cast<uint32_t>(block.im[i].to_int()), bfp_mant_bits);
+}
+#endif
+
+// call the design under test for one clock cycle
+// (define DATAFLOW_TOP to simulate the dataflow version ssr_multistage_decimator_df,
+//  BFP_TOP to simulate ssr_multistage_decimator_bfp: the output is decompressed by the host decompressor,
+//  PFB_TOP to simulate ssr_multistage_decimator_pfb in channelizer mode)
+void runDut(dec_factor_t dec_factor, const dataInputInterface_t &din, dataOutputInterface_t &dout)
+{
+#if defined(BFP_TOP)
+    bfp_block_t<bfp_mant_bits> block;
+    ssr_multistage_decimator_bfp(dec_factor, din.tvalid, din.tdata, din.phase_reset, dout.tvalid, block, dout.sample_index);
+    uint8_t bytes[32];
+    int16_t iq[2 * ssr];
+    packBfpBlock(block, bytes);
+    bfp_decompress(bytes, 1, bfp_mant_bits, iq);
+    for (size_t i = 0; i < ssr; ++i)
+    {
+        dout.tdata.re[i].range() = iq[2 * i];
+        dout.tdata.im[i].range() = iq[2 * i + 1];
+    }
+#elif defined(MONITOR_TOP)
+    ssr_multistage_decimator_mon(dec_factor, din.tvalid, din.tdata, din.phase_reset, dout.tvalid, dout.tdata, dout.sample_index,
+                                 snap.trigger, snap.tap, snap.length, snap.arm, snap.force,
+                                 snap.rd_addr, snap.rd_data, snap.status,
+                                 pwr.src, pwr.length, pwr.hold, pwr.sum, pwr.count, iqOverflow);
+#elif defined(PFB_TOP)
+    ssr_multistage_decimator_pfb(dec_factor, true, din.tvalid, din.tdata, din.phase_reset, dout.tvalid, dout.tdata, dout.sample_index);
+#elif defined(DATAFLOW_TOP)
+    hls::stream<cdatain_vec_t<ssr>> tdata_i;
+    hls::stream<bool> phase_reset_i;
+    hls::stream<cdataout_vec_t<ssr>> tdata_o;
+    hls::stream<sample_index_t> sample_index_o;
+    // the phase reset marker goes with the first valid word at or after the rising edge (as in the flat version)
+    static bool phaseResetPrev = false;
+    static bool phaseResetPending = false;
+    bool phaseReset = (din.phase_reset && !phaseResetPrev) || phaseResetPending;
+    phaseResetPrev = din.phase_reset;
+    phaseResetPending = phaseReset && !din.tvalid;
+    if (din.tvalid)
+    {
+        tdata_i.write(din.tdata);
+        phase_reset_i.write(phaseReset);
+    }
+    ssr_multistage_decimator_df(dec_factor, tdata_i, phase_reset_i, tdata_o, sample_index_o);
+    dout.tvalid = !tdata_o.empty();
+    if (dout.tvalid)
+    {
+        dout.tdata = tdata_o.read();
+        dout.sample_index = sample_index_o.read();
+    }
+#else
+    ssr_multistage_decimator(dec_factor, din.tvalid, din.tdata, din.phase_reset, dout.tvalid, dout.tdata, dout.sample_index);
+#endif
+}
+
+// read the next line of the input test vector file
+// (define INPUT_GAPS to insert idle cycles between the input words, as an input interface with clock-domain gaps:
+//  about one cycle in four is idle, the line is empty and the file is not read)
+bool readInputLine(std::ifstream &inputFile, std::string &line)
+{
+#ifdef INPUT_GAPS
+    // pseudo-random gap pattern (linear congruential generator, fixed seed)
+    static uint32_t gapState = 12345;
+    gapState = gapState * 1664525u + 1013904223u;
+    if (inputFile && ((gapState >> 24) & 3) == 0)
+    {
+        line.clear();
+        return true;
+    }
+#endif
+    return static_cast<bool>(std::getline(inputFile, line));
+}
+
+#ifdef MONITOR_TOP
+// read the snapshot buffer through the read address/data registers, compare it with the expected words
+// and write it to work/snapshot.txt (same format as the valid lines of output_csim.txt)
+int checkSnapshot(const std::vector<cdataout_vec_t<ssr>> &expected, dec_factor_t dec_factor, const dataInputInterface_t &din, dataOutputInterface_t &dout)
+{
+    std::ofstream snapshotFile("work/snapshot.txt");
+    runDut(dec_factor, din, dout);
+    int numWords = snap.status.range(15, 0);
+    int errors = (numWords != snapshotLength) || !snap.status[31];
+
+    for (int n = 0; n < numWords; ++n)
+    {
+        dataOutputInterface_t word;
+        word.tvalid = true;
+        for (size_t i = 0; i < ssr; ++i)
+        {
+            snap.rd_addr = n * ssr + i;
+            runDut(dec_factor, din, dout);
+            ap_int<16> re = snap.rd_data.range(15, 0);
+            ap_int<16> im = snap.rd_data.range(31, 16);
+            word.tdata.re[i].range() = re;
+            word.tdata.im[i].range() = im;
+            if (n < (int)expected.size())
+            {
+                ap_int<dataout_bits> ref_re = expected[n].re[i].range();
+                ap_int<dataout_bits> ref_im = expected[n].im[i].range();
+                errors += (ref_re != re) || (ref_im != im);
+            }
+        }
+        writeOutput(snapshotFile, word, ssr);
+    }
+
+    if (errors)
+    {
+        std::cout << RED << "Snapshot FAIL: " << errors << " errors, " << numWords << " words captured" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Snapshot PASS: " << numWords << " words captured from tap " << snap.tap << RESET << std::endl;
+    return 0;
+}
+
+// IQ_TDM overflow flag: clear after the previous tests (the phase resets did not change the decimation phase faster
+// than the idle input cycles recover it), then set by phase resets every 3 input words without idle cycles: each one
+// changes the decimation phase of dec16 (odd period), and dec32 falls behind by one clock cycle each time (always clear
+// without IQ_TDM)
+int checkIqOverflow(dec_factor_t dec_factor)
+{
+    dataInputInterface_t din = {};
+    dataOutputInterface_t dout;
+    runDut(dec_factor, din, dout);
+    bool overflowBefore = iqOverflow;
+    const int numWords = 256;
+    din.tvalid = true;
+    for (int t = 0; t < numWords; ++t)
+    {
+        din.phase_reset = (t % 3 == 0);
+        runDut(dec_factor, din, dout);
+    }
+#ifdef IQ_TDM
+    const bool overflowExpected = true;
+#else
+    const bool overflowExpected = false;
+#endif
+    if (overflowBefore || iqOverflow != overflowExpected)
+    {
+        std::cout << RED << "IQ overflow FAIL: flag " << overflowBefore << " before, " << iqOverflow << " after " << numWords
+                  << " words with a phase reset every 3 words (expected " << overflowExpected << ")" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "IQ overflow PASS: flag " << iqOverflow << " after " << numWords << " words with a phase reset every 3 words"
+              << RESET << std::endl;
+    return 0;
+}
+#endif
+
+#ifndef PFB_TOP
+// phase reset test: the input words are sent again, with a phase reset on the first word and a mid-stream phase reset
+// on the word phaseResetWord. The sample index restarts from 0 at the output of each marked word, and the output of
+// both runs is compared with the software model (sw/src/simd_decimator.h) over the whole input, where the marked
+// samples are kept by every stage (the decimation phase realigns, the filter state is kept).
+int checkPhaseReset(dec_factor_t dec_factor, const std::vector<cdatain_vec_t<ssr>> &input, const std::vector<cdataout_vec_t<ssr>> &output)
+{
+    const int d = dec_factor.to_int();
+    const int resetSample = phaseResetWord * ssr;
+    const int endSample = input.size() * ssr;
+    // output units (words, or BFP blocks of ssr samples) before the mid-stream phase reset and after it
+#ifdef BFP_TOP
+    // a partial block is dropped at the phase reset
+    const uint64_t step = ssr * d;
+    const int unitsBefore = (resetSample + d - 1) / d / ssr;
+    const int unitsAfter = (endSample - resetSample + d - 1) / d / ssr;
+#else
+    const uint64_t step = (d < ssr) ? ssr : d;
+    const int unitsBefore = (resetSample + step - 1) / step;
+    const int unitsAfter = (endSample - resetSample + step - 1) / step;
+#endif
+
+    std::cout << "Send input samples with a phase reset at input sample " << resetSample << "..." << std::endl;
+    const int flushClocks = 400;
+    dataInputInterface_t din = {};
+    dataOutputInterface_t dout;
+    std::vector<cdataout_vec_t<ssr>> outputReset;
+    int units = 0;
+    int indexErrors = 0;
+    for (size_t t = 0; t < input.size() + flushClocks; ++t)
+    {
+        din.tvalid = t < input.size();
+        if (din.tvalid)
+        {
+            din.tdata = input[t];
+        }
+        din.phase_reset = (t == 0) || (t == phaseResetWord);
+        runDut(dec_factor, din, dout);
+        if (dout.tvalid)
+        {
+            // the index restarts from 0 at the first output unit of the mid-stream phase reset
+            uint64_t expected = step * ((units < unitsBefore) ? units : units - unitsBefore);
+            indexErrors += (dout.sample_index != expected);
+            units++;
+            outputReset.push_back(dout.tdata);
+        }
+    }
+
+    int dataErrors = 0;
+    int numSamples = 0;
+#ifndef BFP_TOP
+    // software model of both runs: first run from the first phase reset, second run with the two phase resets
+    simd_decimator<1> model;
+    model.configure(d);
+    std::vector<int16_t> expected;
+    for (int run = 0; run < 2; ++run)
+    {
+        for (size_t n = 0; n < input.size(); ++n)
+        {
+            for (size_t i = 0; i < ssr; ++i)
+            {
+                int16_t re = std::lround(std::ldexp(input[n].re[i].to_double(), datain_fractional_bits));
+                int16_t im = std::lround(std::ldexp(input[n].im[i].to_double(), datain_fractional_bits));
+                int16_t y_re, y_im;
+                if (i == 0 && (n == 0 || (run == 1 && n == phaseResetWord)))
+                {
+                    model.phase_reset();
+                }
+                if (model.process(&re, &im, 1, &y_re, &y_im))
+                {
+                    expected.push_back(y_re);
+                    expected.push_back(y_im);
+                }
+            }
+        }
+    }
+    // valid lanes of the output words of both runs, in s16.15 format
+    const size_t lanes = (d < ssr) ? ssr / d : 1;
+    std::vector<cdataout_vec_t<ssr>> words = output;
+    words.insert(words.end(), outputReset.begin(), outputReset.end());
+    std::vector<int16_t> actual;
+    for (const cdataout_vec_t<ssr> &word : words)
+    {
+        for (size_t i = 0; i < lanes; ++i)
+        {
+            actual.push_back(std::lround(std::ldexp(word.re[i].to_double(), datain_fractional_bits)));
+            actual.push_back(std::lround(std::ldexp(word.im[i].to_double(), datain_fractional_bits)));
+        }
+    }
+    numSamples = expected.size() / 2;
+    dataErrors = (actual.size() != expected.size());
+    for (size_t k = 0; k < actual.size() && k < expected.size(); ++k)
+    {
+        dataErrors += (actual[k] != expected[k]);
+    }
+#endif
+
+    if (indexErrors || dataErrors || units != unitsBefore + unitsAfter)
+    {
+        std::cout << RED << "Phase reset FAIL: " << units << " output words (expected " << unitsBefore + unitsAfter << "), "
+                  << indexErrors << " sample index errors, " << dataErrors << " data errors" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Phase reset PASS: sample index 0 at output word " << unitsBefore << ", " << numSamples
+              << " output samples match the model" << RESET << std::endl;
+    return 0;
+}
+
+#ifdef GOLDEN_CHECK
+// golden check: zero words clear the filter state (as at the start of the C-simulation), then the reference stimulus
+// golden/input_test_vector.txt is sent from a phase reset and the valid output samples are compared with
+// golden/output_dec<d>.txt (the folder data/golden is added to the testbench files by run.tcl, the check is skipped
+// when it is missing)
+int checkGolden(dec_factor_t dec_factor)
+{
+    const int d = dec_factor.to_int();
+    std::ifstream inputFile("golden/input_test_vector.txt");
+    std::ifstream goldenFile("golden/output_dec" + std::to_string(d) + ".txt");
+    if (!inputFile.is_open() || !goldenFile.is_open())
+    {
+        std::cout << YELLOW << "Golden check skipped: no reference vectors in the golden folder" << RESET << std::endl;
+        return 0;
+    }
+    std::vector<cdatain_vec_t<ssr>> input;
+    std::string line;
+    while (std::getline(inputFile, line))
+    {
+        std::istringstream iss(line);
+        cdatain_vec_t<ssr> word;
+        int re, im;
+        size_t i = 0;
+        for (; i < ssr && (iss >> re >> im); ++i)
+        {
+            word.re[i].range() = re;
+            word.im[i].range() = im;
+        }
+        if (i == ssr)
+        {
+            input.push_back(word);
+        }
+    }
+    std::vector<int> expected;
+    int re, im;
+    while (goldenFile >> re >> im)
+    {
+        expected.push_back(re);
+        expected.push_back(im);
+    }
+
+    std::cout << "Send the reference stimulus of the golden folder..." << std::endl;
+    // zero words: longer than the memory of the filters at the largest decimation factor
+    const int zeroWords = 2 * 64 * hbf_num_taps / ssr;
+    const int flushClocks = 400;
+    dataInputInterface_t din = {};
+    dataOutputInterface_t dout;
+    const size_t lanes = (d < ssr) ? ssr / d : 1;
+    std::vector<int> actual;
+    for (int t = 0; t < zeroWords + flushClocks; ++t)
+    {
+        din.tvalid = t < zeroWords;
+        runDut(dec_factor, din, dout);
+    }
+    for (size_t t = 0; t < input.size() + flushClocks; ++t)
+    {
+        din.tvalid = t < input.size();
+        if (din.tvalid)
+        {
+            din.tdata = input[t];
+        }
+        din.phase_reset = (t == 0);
+        runDut(dec_factor, din, dout);
+        for (size_t i = 0; dout.tvalid && i < lanes; ++i)
+        {
+            actual.push_back(std::lround(std::ldexp(dout.tdata.re[i].to_double(), datain_fractional_bits)));
+            actual.push_back(std::lround(std::ldexp(dout.tdata.im[i].to_double(), datain_fractional_bits)));
+        }
+    }
+
+    int errors = (actual.size() != expected.size());
+    for (size_t k = 0; k < actual.size() && k < expected.size(); ++k)
+    {
+        errors += (actual[k] != expected[k]);
+    }
+    if (errors)
+    {
+        std::cout << RED << "Golden FAIL: " << actual.size() / 2 << " output samples (expected " << expected.size() / 2
+                  << "), " << errors << " errors" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Golden PASS: " << expected.size() / 2 << " output samples match the reference vectors"
+              << RESET << std::endl;
+    return 0;
+}
+#endif
+#endif
+
+#ifdef INTERP_TOP
+// model of an interpolation stage: zero stuffing, prototype filter, gain 2, truncation and saturation to s16.15
+std::vector<std::complex<double>> interpolatorStage(const std::vector<std::complex<double>> &x)
+{
+    auto quantize = [](double v) {
+        double q = std::floor(std::ldexp(v, data_fractional_bits));
+        q = std::min(std::max(q, -std::ldexp(1.0, data_fractional_bits)), std::ldexp(1.0, data_fractional_bits) - 1);
+        return std::ldexp(q, -data_fractional_bits);
+    };
+    std::vector<std::complex<double>> y(2 * x.size());
+    for (size_t n = 0; n < y.size(); ++n)
+    {
+        std::complex<double> acc = 0;
+        // only the even taps of the zero-stuffed input are not zero
+        for (int k = n & 1; k < hbf_num_taps && k <= (int)n; k += 2)
+        {
+            acc += std::ldexp((double)hbf_coef[k], -coef_fractional_bits) * x[(n - k) / 2];
+        }
+        y[n] = std::complex<double>(quantize(2 * acc.real()), quantize(2 * acc.imag()));
+    }
+    return y;
+}
+
+// interpolator test: the samples of the input test vector (all the lanes, in order) are sent when the interpolator
+// requests an input word (8 / int_factor samples per word, one above int_factor 8), then zero words flush the stages.
+// The output is written to work/output_csim.txt and compared with the model of the stages (bit-exact).
+int runInterpolator(int_factor_t int_factor, std::ifstream &inputFile, std::ofstream &outputFile)
+{
+    std::vector<std::complex<double>> input;
+    std::string line;
+    while (std::getline(inputFile, line))
+    {
+        std::istringstream iss(line);
+        int re, im;
+        while (iss >> re >> im)
+        {
+            input.push_back(std::complex<double>(std::ldexp((double)re, -datain_fractional_bits), std::ldexp((double)im, -datain_fractional_bits)));
+        }
+    }
+
+    const int samplesPerWord = (int_factor < ssr) ? ssr / int_factor.to_int() : 1;
+    const int flushClocks = 400;
+    std::vector<std::complex<double>> sent;
+    std::vector<cdataout_vec_t<ssr>> output;
+    size_t next = 0;
+    int flush = 0;
+    dataInputInterface_t din = {};
+    dataOutputInterface_t dout;
+    bool tready = true;
+
+    std::cout << "Send input samples..." << std::endl;
+    while (flush < flushClocks)
+    {
+        // the input word of the previous request has been taken, prepare the next one
+        din.tvalid = next < input.size();
+        for (int i = 0; i < samplesPerWord && din.tvalid; ++i)
+        {
+            std::complex<double> x = (next + i < input.size()) ? input[next + i] : 0;
+            din.tdata.re[i] = x.real();
+            din.tdata.im[i] = x.imag();
+        }
+        ssr_multistage_interpolator(int_factor, din.tvalid, din.tdata, tready, dout.tvalid, dout.tdata);
+        if (tready)
+        {
+            // the word is taken (a zero word when no input word is valid)
+            for (int i = 0; i < samplesPerWord; ++i)
+            {
+                sent.push_back(din.tvalid ? std::complex<double>(din.tdata.re[i].to_double(), din.tdata.im[i].to_double()) : 0);
+            }
+            next += din.tvalid ? samplesPerWord : 0;
+        }
+        flush += !din.tvalid;
+        if (dout.tvalid)
+        {
+            output.push_back(dout.tdata);
+        }
+        writeOutput(outputFile, dout, ssr);
+    }
+
+    // model of the stages
+    std::vector<std::complex<double>> expected = sent;
+    for (int factor = int_factor.to_int(); factor > 1; factor /= 2)
+    {
+        expected = interpolatorStage(expected);
+    }
+
+    int errors = 0;
+    for (size_t n = 0; n < output.size() && n < expected.size() / ssr; ++n)
+    {
+        for (size_t i = 0; i < ssr; ++i)
+        {
+            dataout_t re = expected[n * ssr + i].real();
+            dataout_t im = expected[n * ssr + i].imag();
+            errors += (output[n].re[i].to_double() != re.to_double()) || (output[n].im[i].to_double() != im.to_double());
+        }
+    }
+
+    if (errors || output.empty())
+    {
+        std::cout << RED << "Interpolator FAIL: " << errors << " errors in " << output.size() << " words" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Interpolator PASS: " << next << " input samples, " << output.size() << " output words, interpolation factor "
+              << int_factor << RESET << std::endl;
+    return 0;
+}
+#endif
+
+#ifdef PFB_TOP
+// compare a delay line with a reference model: the output is the input written depth enabled cycles before
+// (0 before the first depth writes), the enable follows a pseudo-random pattern
+template <int policy, int depth>
+int checkDelayLine()
+{
+    static delay_line<data_t, depth, policy> dl;
+    std::vector<data_t> written;
+    uint32_t lfsr = 0x12345678u + depth;
+    int errors = 0;
+
+    for (int t = 0; t < 8 * depth + 64; ++t)
+    {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        bool enable = (lfsr >> 28) > 4;
+        data_t din;
+        din.range() = (lfsr >> 8) & 0xFFFF;
+        data_t dout = dl.shift(din, enable);
+        data_t expected = (written.size() >= (size_t)depth) ? written[written.size() - depth] : data_t(0);
+        errors += (dout != expected);
+        if (enable)
+        {
+            written.push_back(din);
+        }
+    }
+    return errors;
+}
+
+template <int depth>
+int checkDelayLinePolicies()
+{
+    return checkDelayLine<DL_REG, depth>() + checkDelayLine<DL_SRL, depth>() + checkDelayLine<DL_BRAM, depth>() +
+           checkDelayLine<DL_URAM, depth>() + checkDelayLine<DL_AUTO, depth>();
+}
+
+int checkDelayLines()
+{
+    // DL_AUTO resolves to registers, SRL and block RAM
+    int errors = checkDelayLinePolicies<1>() + checkDelayLinePolicies<2>() + checkDelayLinePolicies<pfb_channels>() +
+                 checkDelayLinePolicies<dl_max_srl_depth + 3>();
+
+    if (errors)
+    {
+        std::cout << RED << "Delay lines FAIL: " << errors << " errors" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Delay lines PASS: DL_REG, DL_SRL, DL_BRAM, DL_URAM, DL_AUTO" << RESET << std::endl;
+    return 0;
+}
+
+// compare the channelizer output with a double precision model (same quantized prototype filter, DFT of the
+// polyphase branches): the output word n is the word q = n % (M / 8) of the channel block m = n / (M / 8),
+// channel k = q + k1 M / 8 on lane k1, y_k(m) = sum_p v_p(m) exp(-j 2 pi k p / M) / (M / 2),
+// v_p(m) = sum_r h(r M + M - 1 - p) x((m - r) M + p) (x: input samples from the phase reset)
+int checkChannelizer(const std::vector<cdatain_vec_t<ssr>> &input, const std::vector<cdataout_vec_t<ssr>> &output)
+{
+    const int M = pfb_channels;
+    const int words = M / ssr;
+    const double pi = std::acos(-1.0);
+    const double lsb = std::ldexp(1.0, -dataout_fractional_bits);
+    int errors = 0;
+    double maxError = 0;
+
+    for (size_t n = 0; n < output.size(); ++n)
+    {
+        int m = n / words;
+        int q = n % words;
+        std::complex<double> v[pfb_channels];
+        for (int p = 0; p < M; ++p)
+        {
+            for (int r = 0; r < pfb_taps_per_branch; ++r)
+            {
+                int sample = (m - r) * M + p;
+                if (sample < 0)
+                    continue;
+                const cdatain_vec_t<ssr> &word = input[sample / ssr];
+                std::complex<double> x(word.re[sample % ssr].to_double(), word.im[sample % ssr].to_double());
+                v[p] += std::ldexp((double)pfb_coef[r * M + M - 1 - p], -coef_fractional_bits) * x;
+            }
+        }
+        for (int k1 = 0; k1 < ssr; ++k1)
+        {
+            int k = q + words * k1;
+            std::complex<double> y = 0;
+            for (int p = 0; p < M; ++p)
+            {
+                y += v[p] * std::polar(1.0, -2 * pi * k * p / M);
+            }
+            y /= M / 2;
+            // saturation of the output samples
+            double re = std::min(std::max(y.real(), -1.0), 1.0 - lsb);
+            double im = std::min(std::max(y.imag(), -1.0), 1.0 - lsb);
+            double error = std::max(std::abs(output[n].re[k1].to_double() - re), std::abs(output[n].im[k1].to_double() - im));
+            maxError = std::max(maxError, error);
+            errors += (error > 2 * lsb);
+        }
+    }
+
+    if (errors || output.empty())
+    {
+        std::cout << RED << "Channelizer FAIL: " << errors << " errors in " << output.size() << " words" << RESET << std::endl;
+        return 1;
+    }
+    std::cout << GREEN << "Channelizer PASS: " << output.size() << " words of " << M << " channels, max error " << maxError / lsb << " lsb" << RESET << std::endl;
+    return 0;
+}
+#endif
+
 void readParameterFile(std::ifstream &parameterFile, dec_factor_t &dec_factor)
 {
     // Read the file line by line
@@ -275,12 +1148,31 @@ void writeOutput(std::ofstream &outputFile, const dataOutputInterface_t &dout, c
 
     outputFile << std::setw(4) << dout.tvalid << " ";
 
+#if DATAOUT_BITS != 16 && !defined(BFP_TOP)
+    // packed output samples: pack the output word as on the output bus, then unpack it with the host code,
+    // the samples are written in s16.15 format (same scale as the 16-bit output)
+    uint8_t bytes[2 * ssr * 2];
+    int16_t iq[2 * ssr];
+    std::size_t pos = 0;
+    std::memset(bytes, 0, sizeof(bytes));
+    for (size_t i = 0; i < ssr; ++i)
+        putBits(bytes, pos, static_cast<uint32_t>(dout.tdata.re[i].range()), dataout_bits);
+    for (size_t i = 0; i < ssr; ++i)
+        putBits(bytes, pos, static_cast<uint32_t>(dout.tdata.im[i].range()), dataout_bits);
+    unpack_samples(bytes, 1, dataout_bits, iq);
+#endif
+
     // Cast to fixed point integer and write the output to file
     for (size_t i = 0; i < ssr; ++i)
     {
+#if DATAOUT_BITS != 16 && !defined(BFP_TOP)
+        int16_t out_re = iq[2 * i];
+        int16_t out_im = iq[2 * i + 1];
+#else
         // Cast to fixed point integer
         ap_int<dataout_bits> out_re = dout.tdata.re[i].range();
         ap_int<dataout_bits> out_im = dout.tdata.im[i].range();
+#endif
 
         outputFile << std::setw(6) << out_re << " ";
         outputFile << std::setw(6) << out_im;
@@ -18,13 +18,32 @@
 set CSYNTH 1
 set EXPORT 0
 
-### default setting
-set Project     prj_ssr_multistage_decimator
-set Solution    solution_1
-set Device      "xczu28dr-ffvg1517-2-e"
-set Flow        ""
-set ClockFreq   160       ;# Set the desired clock frequency in MHz
-set Uncertainty 0.3
+### default setting (not applied when the settings are given by run_sweep.tcl)
+if {![info exists SweepConfig]} {
+    set Project     prj_ssr_multistage_decimator
+    set Solution    solution_1
+    set Device      "xczu28dr-ffvg1517-2-e"
+    set Flow        ""
+    set ClockFreq   160       ;# Set the desired clock frequency in MHz
+    set Uncertainty 0.3
+    # top level function:
+    #  - ssr_multistage_decimator:    all the stages flattened in one pipeline
+    #  - ssr_multistage_decimator_df: dataflow, each stage is a process connected by streams
+    #  - ssr_multistage_decimator_bfp: block floating point compressed output
+    #  - ssr_multistage_decimator_mon: snapshot capture and power meter of the stage outputs (AXI-Lite registers)
+    #  - ssr_multistage_decimator_pfb: multistage decimator or polyphase filter bank channelizer (chan_mode)
+    #  - ssr_multistage_interpolator: multistage interpolator (transmit path), the parameter is the interpolation factor
+    set Top         ssr_multistage_decimator
+    # compiler flags of the design sources (compile-time options),
+    # e.g. "-DBFP_MANTISSA_BITS=10" to select the mantissa bits of the BFP output (8, 10, 12),
+    #      "-DDATAOUT_BITS=12" to select the output word length (16, 12, 8)
+    #      "-DCOEF_BITS=27" to select the coefficient word length (18, 24, 27 - DSP58)
+    #      "-DDEC2_FS4_SHIFT=1" to shift the input of the first stage by +fs/4 (0, 1, -1; DEC4_FS4_SHIFT for the second stage)
+    #      "-DSSR_FFA" to implement dec2_ssr8 and dec2_ssr4 with the fast FIR algorithm (fewer multipliers)
+    #      "-DIQ_TDM" to compute the I and Q samples of dec32 and dec64 with the same multipliers
+    #      "-DPFB_CHANNELS=32" to select the number of channels of the channelizer (16, 32)
+    set CFlags      ""
+}
 
 # Calculate the clock period in nanoseconds from the clock frequency in MHz
 set ClockPeriod [expr {1000.0 / $ClockFreq}]
@@ -39,10 +58,17 @@ set TopDir [pwd]
 set WorkDir "$TopDir/data/work"
 
 # Add the file for synthesis
-add_files $TopDir/hw/src/ssr_multistage_decimator.cpp 
-
-# Add testbench files for co-simulation
-add_files -tb  $TopDir/hw/tb/tb_ssr_multistage_decimator.cpp
+add_files $TopDir/hw/src/ssr_multistage_decimator.cpp -cflags $CFlags
+
+# Add testbench files for co-simulation (the testbench is compiled for the selected top)
+set TbFlags [dict create \
+    ssr_multistage_decimator     "" \
+    ssr_multistage_decimator_df  "-DDATAFLOW_TOP" \
+    ssr_multistage_decimator_bfp "-DBFP_TOP" \
+    ssr_multistage_decimator_mon "-DMONITOR_TOP" \
+    ssr_multistage_decimator_pfb "-DPFB_TOP" \
+    ssr_multistage_interpolator  "-DINTERP_TOP" ]
+add_files -tb  $TopDir/hw/tb/tb_ssr_multistage_decimator.cpp -cflags "[dict get $TbFlags $Top] $CFlags"
 
 # create the work directory if it does not exist
 if {![file exists $WorkDir]} {
@@ -50,9 +76,11 @@ if {![file exists $WorkDir]} {
 }
 # add the folder, as there seems to be a bug in the tool when adding files separately
 add_files -tb $WorkDir
+# reference vectors of the default build (golden check of the testbench)
+add_files -tb $TopDir/data/golden
 
 # Set top module of the design
-set_top ssr_multistage_decimator
+set_top $Top
 
 # Solution settings
 open_solution -reset $Solution
@@ -68,18 +96,85 @@ set_clock_uncertainty $Uncertainty
 ## Directives #
 ##############
 
-# IO interface
-set_directive_interface -mode ap_ctrl_none ssr_multistage_decimator
-set_directive_interface -mode ap_none ssr_multistage_decimator dec_factor
-set_directive_interface -mode ap_none ssr_multistage_decimator tvalid_i
-set_directive_interface -mode ap_none ssr_multistage_decimator tdata_i
-set_directive_interface -mode ap_none ssr_multistage_decimator tvalid_o
-set_directive_interface -mode ap_none ssr_multistage_decimator tdata_o
-
-# The function has a pipelined architecture and accepts new inputs every clock cycle
-set_directive_pipeline -II 1  ssr_multistage_decimator
-# Inline the functions for highest performance
-set_directive_inline -recursive ssr_multistage_decimator
+if {$Top == "ssr_multistage_decimator_df"} {
+
+    # IO interface
+    set_directive_interface -mode ap_ctrl_none $Top
+    set_directive_interface -mode ap_none $Top dec_factor
+    set_directive_stable $Top dec_factor
+    set_directive_interface -mode axis -register_mode both $Top tdata_i
+    set_directive_interface -mode axis -register_mode both $Top phase_reset_i
+    set_directive_interface -mode axis -register_mode both $Top tdata_o
+    set_directive_interface -mode axis -register_mode both $Top sample_index_o
+    # The output samples are packed on the bus without padding (DATAOUT_BITS = 12 or 8)
+    set_directive_aggregate -compact bit $Top tdata_o
+
+    # Initiation interval of each stage process (StageII)
+    source $TopDir/scripts/df_stages.tcl
+
+    # Each process is a free-running pipeline
+    dict for {process ii} $StageII {
+        set_directive_inline -off $process
+        set_directive_pipeline -II $ii -style frp $process
+    }
+    # Inline the stage functions and the MAC engines into the processes
+    # (the single-rate stages are inlined by a pragma in df_dec2_ssr1)
+    set_directive_inline -recursive dec2_ssr8
+    set_directive_inline -recursive dec2_ssr4
+    set_directive_inline -recursive dec2_ssr2
+
+} elseif {$Top == "ssr_multistage_interpolator"} {
+
+    # IO interface
+    set_directive_interface -mode ap_ctrl_none $Top
+    set_directive_interface -mode ap_none $Top int_factor
+    set_directive_stable $Top int_factor
+    set_directive_interface -mode ap_none $Top tvalid_i
+    set_directive_interface -mode ap_none $Top tdata_i
+    set_directive_interface -mode ap_none $Top tready_o
+    set_directive_interface -mode ap_none $Top tvalid_o
+    set_directive_interface -mode ap_none $Top tdata_o
+    # The output samples are packed on the bus without padding (DATAOUT_BITS = 12 or 8)
+    set_directive_aggregate -compact bit $Top tdata_o
+
+    # The function has a pipelined architecture and accepts new inputs every clock cycle
+    set_directive_pipeline -II 1 $Top
+    # Inline the functions for highest performance
+    set_directive_inline -recursive $Top
+
+} else {
+
+    # IO interface
+    set_directive_interface -mode ap_ctrl_none $Top
+    set_directive_interface -mode ap_none $Top dec_factor
+    set_directive_interface -mode ap_none $Top tvalid_i
+    set_directive_interface -mode ap_none $Top tdata_i
+    set_directive_interface -mode ap_none $Top phase_reset_i
+    set_directive_interface -mode ap_none $Top tvalid_o
+    set_directive_interface -mode ap_none $Top tdata_o
+    set_directive_interface -mode ap_none $Top sample_index_o
+    # The output samples are packed on the bus without padding (DATAOUT_BITS = 12 or 8, BFP block)
+    set_directive_aggregate -compact bit $Top tdata_o
+
+    if {$Top == "ssr_multistage_decimator_mon"} {
+        # snapshot trigger input and AXI-Lite registers (snapshot capture, power meter, IQ_TDM overflow flag)
+        set_directive_interface -mode ap_none $Top trigger_i
+        foreach reg {snap_tap snap_length snap_arm snap_force snap_rd_addr snap_rd_data snap_status pwr_src pwr_length pwr_hold pwr_sum pwr_count iq_overflow} {
+            set_directive_interface -mode s_axilite -bundle control $Top $reg
+        }
+    }
+
+    if {$Top == "ssr_multistage_decimator_pfb"} {
+        # channelizer or decimator output, quasi-static like dec_factor
+        set_directive_interface -mode ap_none $Top chan_mode
+        set_directive_stable $Top chan_mode
+    }
+
+    # The function has a pipelined architecture and accepts new inputs every clock cycle
+    set_directive_pipeline -II 1 $Top
+    # Inline the functions for highest performance
+    set_directive_inline -recursive $Top
+}
 
 
 #################
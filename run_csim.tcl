@@ -23,6 +23,8 @@ set selection "single"
 
 set projectName     prj_ssr_multistage_decimator
 set solutionName    solution_0
+# top level function of the project (see run.tcl)
+set topName         ssr_multistage_decimator
 
 
 # ------------------------------------------------------------
@@ -177,8 +179,8 @@ foreach testcase $Testcases {
         # -----------------------------------------------
         # Copy the co-simulatior report and log files to the testcase directory
         # -----------------------------------------------
-        set simReportFile "${projectName}/${solutionName}/sim/report/ssr_multistage_decimator_cosim.rpt"
-        set simLogFile "${projectName}/${solutionName}/sim/report/verilog/ssr_multistage_decimator.log"
+        set simReportFile "${projectName}/${solutionName}/sim/report/${topName}_cosim.rpt"
+        set simLogFile "${projectName}/${solutionName}/sim/report/verilog/${topName}.log"
 
         #
         set destinationFile [file join $testcaseDir [file tail $simReportFile]]
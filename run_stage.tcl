@@ -0,0 +1,119 @@
+##
+# @file run_stage.tcl
+# @brief TCL script to synthesize and export each stage of the dataflow decimator (ssr_multistage_decimator_df)
+#        as a separate IP. Each stage has its own project (prj_<stage>), so a change in one stage only requires
+#        the synthesis of that stage. The exported IPs are composed in Vivado by scripts/compose_stages.tcl.
+#
+# @usage vitis_hls -f run_stage.tcl
+#        vitis_hls -i -> interactive mode, then type "source run_stage.tcl"
+#        vitis-run --mode hls --tcl run_stage.tcl
+#
+#
+# Set Stages to the list of stages to be synthesized (e.g. "df_dec64"), or to "all".
+# The IPs are exported to the ip_repo folder.
+#
+##
+
+set CSYNTH 1
+set EXPORT 1
+
+### default setting
+set Stages      all       ;# all, or a list of processes from StageList (scripts/df_stages.tcl)
+set Solution    solution_1
+set Device      "xczu28dr-ffvg1517-2-e"
+set Flow        ""
+set ClockFreq   160       ;# Set the desired clock frequency in MHz (ap_clk, the pumped stages run at ClockFreq x StagePump)
+set Uncertainty 0.3
+set CFlags      ""        ;# compiler flags of the design sources (compile-time options, see run.tcl)
+
+# Set the top directory and use absolute path to fix issue with relative paths
+set TopDir [pwd]
+set IpRepo "$TopDir/ip_repo"
+
+# Stage settings (StageList, StageII, StagePump, StagePorts)
+source $TopDir/scripts/df_stages.tcl
+
+if {$Stages == "all"} {
+    set Stages $StageList
+}
+
+if {![file exists $IpRepo]} {
+    file mkdir $IpRepo
+}
+
+#### main part
+
+foreach Stage $Stages {
+
+    if {![dict exists $StageII $Stage]} {
+        puts "Invalid stage $Stage"
+        exit
+    }
+
+    # a pumped stage runs in a faster clock, with a larger initiation interval (StagePump)
+    set Pump [dict get $StagePump $Stage]
+    set StageClockFreq [expr {$ClockFreq * $Pump}]
+    set ClockPeriod [expr {1000.0 / $StageClockFreq}]
+    set II [expr {[dict get $StageII $Stage] * $Pump}]
+
+    puts "Processing stage $Stage ($StageClockFreq MHz, II = $II)"
+
+    # Project settings
+    open_project prj_$Stage -reset
+
+    # Add the file for synthesis
+    add_files $TopDir/hw/src/ssr_multistage_decimator.cpp -cflags $CFlags
+
+    # Set top module of the design
+    set_top $Stage
+
+    # Solution settings
+    open_solution -reset $Solution
+
+    # set Part Number
+    set_part $Device
+
+    # Set the target clock period
+    create_clock -period $ClockPeriod
+    set_clock_uncertainty $Uncertainty
+
+    ###############
+    ## Directives #
+    ##############
+
+    # IO interface
+    set_directive_interface -mode ap_ctrl_none $Stage
+    foreach port [dict get $StagePorts $Stage] {
+        set_directive_interface -mode axis -register_mode both $Stage $port
+    }
+    if {$Stage == "df_output"} {
+        set_directive_interface -mode ap_none $Stage dec_factor
+        set_directive_stable $Stage dec_factor
+    }
+
+    # Free-running pipeline, with the initiation interval given by the input sample rate of the stage
+    # (and by the pump factor: the multipliers are shared by Pump products)
+    set_directive_pipeline -II $II -style frp $Stage
+    # Inline the stage functions and the MAC engines
+    set_directive_inline -recursive dec2_ssr8
+    set_directive_inline -recursive dec2_ssr4
+    set_directive_inline -recursive dec2_ssr2
+
+    #############
+    # SYNTHESIS #
+    #############
+    if {$CSYNTH == 1} {
+        csynth_design
+    }
+
+    ##########
+    # EXPORT #
+    ##########
+    if {$EXPORT == 1} {
+        export_design -format ip_catalog -ipname $Stage -output $IpRepo/$Stage.zip
+    }
+
+    close_project
+}
+
+#exit
@@ -0,0 +1,75 @@
+##
+# @file run_sweep.tcl
+# @brief TCL script to synthesize the ssr_multistage_decimator over a matrix of configurations
+#        (top level architecture, compile-time options, device, clock frequency) and collect the
+#        resource usage and the estimated Fmax of each configuration in a CSV file.
+#
+# @usage vitis_hls -f run_sweep.tcl
+#        vitis_hls -i -> interactive mode, then type "source run_sweep.tcl"
+#        vitis-run --mode hls --tcl run_sweep.tcl
+#
+# Each configuration is synthesized by run.tcl in its own project (prj_sweep_<n>).
+# The reports are collected by scripts/collect_synth_reports.py into sweep_results.csv.
+#
+##
+
+### sweep setting
+# top level functions (see run.tcl)
+set SweepTops    {ssr_multistage_decimator ssr_multistage_decimator_df}
+# compile-time options of the design, one entry per configuration ("" = default):
+# fast FIR algorithm, I/Q time-multiplexing of the dec32/dec64 stages, 24 and 27-bit coefficients
+set SweepCFlags  {"" "-DSSR_FFA" "-DIQ_TDM" "-DCOEF_BITS=24" "-DCOEF_BITS=27"}
+# devices
+set SweepDevices {"xczu28dr-ffvg1517-2-e" "xcvc1902-vsva2197-2MP-e-S"}
+# clock frequencies in MHz
+set SweepClocks  {160 250 320}
+
+set ResultFile   sweep_results.csv
+
+#### main part
+
+set TopDir [pwd]
+
+# settings shared by all the configurations
+set SweepConfig 1
+set Solution    solution_1
+set Flow        ""
+set Uncertainty 0.3
+
+# list of the configurations: project name, top, compiler flags, device, clock
+set configList {}
+set n 0
+foreach Top $SweepTops {
+    foreach CFlags $SweepCFlags {
+        foreach Device $SweepDevices {
+            foreach ClockFreq $SweepClocks {
+                lappend configList [list prj_sweep_$n $Top $CFlags $Device $ClockFreq]
+                incr n
+            }
+        }
+    }
+}
+
+# write the list of configurations, read by the report collector
+set fp [open "$TopDir/sweep_configs.csv" w]
+puts $fp "project,top,cflags,device,clock_mhz"
+foreach config $configList {
+    lassign $config Project Top CFlags Device ClockFreq
+    puts $fp "$Project,$Top,\"$CFlags\",$Device,$ClockFreq"
+}
+close $fp
+
+foreach config $configList {
+    lassign $config Project Top CFlags Device ClockFreq
+    puts "Synthesizing $Project: top $Top, cflags \"$CFlags\", device $Device, clock $ClockFreq MHz"
+    if {[catch {source $TopDir/run.tcl} result]} {
+        puts "Synthesis of $Project failed: $result"
+    }
+    close_project
+}
+unset SweepConfig
+
+# collect the reports
+puts [exec python3 $TopDir/scripts/collect_synth_reports.py $TopDir/sweep_configs.csv $TopDir/$ResultFile]
+
+#exit
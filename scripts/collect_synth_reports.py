@@ -0,0 +1,76 @@
+"""
+Collect the synthesis reports of the configurations synthesized by run_sweep.tcl.
+
+For each configuration listed in the configuration file (written by run_sweep.tcl), read the
+Vitis HLS report <project>/solution_1/syn/report/csynth.xml and write one CSV row with the
+resource usage (DSP, LUT, FF, BRAM, URAM) and the estimated Fmax.
+
+Usage: python3 collect_synth_reports.py <sweep_configs.csv> <sweep_results.csv> [solution]
+"""
+
+import csv
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+# resources reported by the tool (DSP48E in older versions of the tool)
+resources = ['DSP', 'LUT', 'FF', 'BRAM_18K', 'URAM']
+
+
+# Function to read a value from the report, returns an empty string if not found
+def find_text(root, path):
+    node = root.find(path)
+    return node.text.strip() if node is not None and node.text is not None else ''
+
+
+# Function to read the resource usage and the timing estimate from a csynth.xml report
+def read_report(report_file):
+    root = ET.parse(report_file).getroot()
+    result = {}
+    for resource in resources:
+        value = find_text(root, f'AreaEstimates/Resources/{resource}')
+        if value == '' and resource == 'DSP':
+            value = find_text(root, 'AreaEstimates/Resources/DSP48E')
+        result[resource] = value
+        available = find_text(root, f'AreaEstimates/AvailableResources/{resource}')
+        if available == '' and resource == 'DSP':
+            available = find_text(root, 'AreaEstimates/AvailableResources/DSP48E')
+        result[resource + '_available'] = available
+    period = find_text(root, 'PerformanceEstimates/SummaryOfTimingAnalysis/EstimatedClockPeriod')
+    result['est_clock_period_ns'] = period
+    result['est_fmax_mhz'] = f'{1000.0 / float(period):.1f}' if period else ''
+    return result
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    config_file = sys.argv[1]
+    result_file = sys.argv[2]
+    solution = sys.argv[3] if len(sys.argv) > 3 else 'solution_1'
+    top_dir = os.path.dirname(os.path.abspath(config_file))
+
+    header = ['project', 'top', 'cflags', 'device', 'clock_mhz', 'status', 'est_clock_period_ns', 'est_fmax_mhz']
+    for resource in resources:
+        header += [resource, resource + '_available']
+
+    with open(config_file, newline='') as fin, open(result_file, 'w', newline='') as fout:
+        writer = csv.DictWriter(fout, fieldnames=header)
+        writer.writeheader()
+        for config in csv.DictReader(fin):
+            row = dict(config)
+            report_file = os.path.join(top_dir, config['project'], solution, 'syn', 'report', 'csynth.xml')
+            if os.path.isfile(report_file):
+                row.update(read_report(report_file))
+                row['status'] = 'ok'
+            else:
+                row['status'] = 'no report'
+            writer.writerow(row)
+            print(f"{config['project']}: {row['status']}")
+
+    print(f'Results written to {result_file}')
+
+
+if __name__ == '__main__':
+    main()
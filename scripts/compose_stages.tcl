@@ -0,0 +1,187 @@
+##
+# @file compose_stages.tcl
+# @brief Vivado TCL script composing the stage IPs exported by run_stage.tcl into the multistage decimator.
+#        It creates a block design with one instance per stage, connects the streams between the stages and
+#        to the output selector, and generates the HDL wrapper.
+#        Only the stages that changed need to be re-exported by run_stage.tcl before running this script.
+#        Optionally, the output stream crosses to a slower consumer clock domain through an async FIFO
+#        (OutputClockFreq, see scripts/output_cdc.tcl).
+#        The stages with a pump factor (StagePump, see scripts/df_stages.tcl) run in a faster clock domain
+#        (ap_clk_<k>x), their streams cross to and from ap_clk through synchronous clock converters.
+#
+# @usage vivado -mode batch -source scripts/compose_stages.tcl (from the top folder)
+#
+##
+
+### default setting
+set Project     prj_ssr_multistage_decimator_bd
+set Design      ssr_multistage_decimator_bd
+set Device      "xczu28dr-ffvg1517-2-e"
+set ClockFreq   160       ;# processing clock (ap_clk) in MHz
+# output clock domain:
+#  - 0: the output stream is in the processing clock domain
+#  - consumer clock (out_clk) in MHz: the output stream crosses to out_clk through an async FIFO,
+#    with no backpressure for the decimation factors >= MinDecFactor
+set OutputClockFreq 0
+set MinDecFactor    16
+# maximum clock of the pumped stages in MHz (the whole stage runs in the pumped clock, not only the DSP slices)
+set MaxPumpClockFreq 500
+
+set TopDir [pwd]
+set IpRepo "$TopDir/ip_repo"
+
+# Stage settings (StageList, StagePump)
+source $TopDir/scripts/df_stages.tcl
+
+# Pumped clock domains: one clock port per pump factor
+set PumpFactors {}
+foreach Stage $StageList {
+    set Pump [dict get $StagePump $Stage]
+    if {$Pump != 1 && $Pump != 2 && $Pump != 4} {
+        puts "Error: pump factor $Pump of $Stage must be 1, 2 or 4"
+        exit
+    }
+    if {$Pump > 1 && [lsearch $PumpFactors $Pump] < 0} {
+        lappend PumpFactors $Pump
+    }
+    if {$ClockFreq * $Pump > $MaxPumpClockFreq} {
+        puts "Error: $Stage at [expr {$ClockFreq * $Pump}] MHz > $MaxPumpClockFreq MHz (MaxPumpClockFreq)"
+        exit
+    }
+}
+
+# clock port of a stage
+proc stage_clock {stage} {
+    global StagePump
+    set pump [dict get $StagePump $stage]
+    if {$pump == 1} {
+        return [get_bd_ports ap_clk]
+    }
+    return [get_bd_ports ap_clk_${pump}x]
+}
+
+# CDC FIFO sizing
+if {$OutputClockFreq > 0} {
+    source $TopDir/scripts/output_cdc.tcl
+    set MinOutputClock [min_output_clock $ClockFreq $MinDecFactor]
+    if {$OutputClockFreq < $MinOutputClock} {
+        puts "Error: output clock $OutputClockFreq MHz < $MinOutputClock MHz required for dec_factor >= $MinDecFactor"
+        exit
+    }
+    set CdcFifoDepth [cdc_fifo_depth $ClockFreq $OutputClockFreq $MinDecFactor]
+    puts "Output clock $OutputClockFreq MHz, CDC FIFO depth $CdcFifoDepth (dec_factor >= $MinDecFactor)"
+}
+
+# Stream connections: {source_instance source_port destination_instance destination_port}
+set Connections {
+    {df_input     tdata_o df_dec2_ssr8 tdata_i}
+    {df_input     tap_o   df_output    tap_dec1}
+    {df_dec2_ssr8 tdata_o df_dec2_ssr4 tdata_i}
+    {df_dec2_ssr8 tap_o   df_output    tap_dec2}
+    {df_dec2_ssr4 tdata_o df_dec2_ssr2 tdata_i}
+    {df_dec2_ssr4 tap_o   df_output    tap_dec4}
+    {df_dec2_ssr2 tdata_o df_dec16     tdata_i}
+    {df_dec2_ssr2 tap_o   df_output    tap_dec8}
+    {df_dec16     tdata_o df_dec32     tdata_i}
+    {df_dec16     tap_o   df_output    tap_dec16}
+    {df_dec32     tdata_o df_dec64     tdata_i}
+    {df_dec32     tap_o   df_output    tap_dec32}
+    {df_dec64     tap_o   df_output    tap_dec64}
+}
+
+#### main part
+
+create_project $Project $TopDir/$Project -part $Device -force
+
+# unzip the exported IPs and add them to the repository
+foreach Stage $StageList {
+    set ipZip "$IpRepo/$Stage.zip"
+    if {![file exists $ipZip]} {
+        puts "Error: $ipZip not found, run run_stage.tcl first"
+        exit
+    }
+    exec unzip -o -q $ipZip -d $IpRepo/$Stage
+}
+set_property ip_repo_paths $IpRepo [current_project]
+update_ip_catalog
+
+create_bd_design $Design
+
+# one instance per stage
+foreach Stage $StageList {
+    create_bd_cell -type ip -vlnv [get_ipdefs -filter "NAME == $Stage"] $Stage
+}
+
+# clock and reset
+# (the pumped clocks must be generated with ap_clk by the same MMCM/PLL; the reset is synchronous to ap_clk)
+create_bd_port -dir I -type clk -freq_hz [expr {int($ClockFreq * 1e6)}] ap_clk
+foreach Pump $PumpFactors {
+    create_bd_port -dir I -type clk -freq_hz [expr {int($ClockFreq * $Pump * 1e6)}] ap_clk_${Pump}x
+}
+create_bd_port -dir I -type rst ap_rst_n
+foreach Stage $StageList {
+    connect_bd_net [stage_clock $Stage] [get_bd_pins $Stage/ap_clk]
+    connect_bd_net [get_bd_ports ap_rst_n] [get_bd_pins $Stage/ap_rst_n]
+}
+
+# streams between the stages, through a clock converter between different clock domains
+foreach conn $Connections {
+    lassign $conn srcCell srcPort dstCell dstPort
+    if {[dict get $StagePump $srcCell] == [dict get $StagePump $dstCell]} {
+        connect_bd_intf_net [get_bd_intf_pins $srcCell/$srcPort] [get_bd_intf_pins $dstCell/$dstPort]
+    } else {
+        # the clocks come from the same MMCM/PLL: synchronous converter with the integer ratio of the pump factors
+        # (slave:master clock frequency), no synchronizer stages as in an async crossing
+        set srcPump [dict get $StagePump $srcCell]
+        set dstPump [dict get $StagePump $dstCell]
+        set minPump [expr {min($srcPump, $dstPump)}]
+        set ratio "[expr {$srcPump / $minPump}]:[expr {$dstPump / $minPump}]"
+        set cdc cdc_${srcCell}_${srcPort}
+        create_bd_cell -type ip -vlnv [get_ipdefs -filter "NAME == axis_clock_converter"] $cdc
+        set_property -dict [list CONFIG.IS_ACLK_ASYNC {0} CONFIG.ACLK_RATIO $ratio] [get_bd_cells $cdc]
+        connect_bd_intf_net [get_bd_intf_pins $srcCell/$srcPort] [get_bd_intf_pins $cdc/S_AXIS]
+        connect_bd_intf_net [get_bd_intf_pins $cdc/M_AXIS] [get_bd_intf_pins $dstCell/$dstPort]
+        connect_bd_net [stage_clock $srcCell] [get_bd_pins $cdc/s_axis_aclk]
+        connect_bd_net [stage_clock $dstCell] [get_bd_pins $cdc/m_axis_aclk]
+        connect_bd_net [get_bd_ports ap_rst_n] [get_bd_pins $cdc/s_axis_aresetn]
+        connect_bd_net [get_bd_ports ap_rst_n] [get_bd_pins $cdc/m_axis_aresetn]
+    }
+}
+
+# external ports
+make_bd_intf_pins_external [get_bd_intf_pins df_input/tdata_i]
+make_bd_intf_pins_external [get_bd_intf_pins df_input/phase_reset_i]
+make_bd_pins_external [get_bd_pins df_output/dec_factor]
+
+# output streams (data and sample index, one word each per output word)
+if {$OutputClockFreq > 0} {
+    create_bd_port -dir I -type clk -freq_hz [expr {int($OutputClockFreq * 1e6)}] out_clk
+}
+foreach port {tdata_o sample_index_o} {
+    if {$OutputClockFreq > 0} {
+        # async FIFO from the processing clock domain to the consumer clock domain
+        set cdc output_cdc_$port
+        create_bd_cell -type ip -vlnv [get_ipdefs -filter "NAME == axis_data_fifo"] $cdc
+        set_property -dict [list \
+            CONFIG.IS_ACLK_ASYNC {1} \
+            CONFIG.FIFO_DEPTH $CdcFifoDepth \
+            CONFIG.SYNCHRONIZATION_STAGES $SyncStages ] [get_bd_cells $cdc]
+        connect_bd_intf_net [get_bd_intf_pins df_output/$port] [get_bd_intf_pins $cdc/S_AXIS]
+        connect_bd_net [get_bd_ports ap_clk] [get_bd_pins $cdc/s_axis_aclk]
+        connect_bd_net [get_bd_ports ap_rst_n] [get_bd_pins $cdc/s_axis_aresetn]
+        connect_bd_net [get_bd_ports out_clk] [get_bd_pins $cdc/m_axis_aclk]
+        make_bd_intf_pins_external [get_bd_intf_pins $cdc/M_AXIS]
+    } else {
+        make_bd_intf_pins_external [get_bd_intf_pins df_output/$port]
+    }
+}
+
+validate_bd_design
+save_bd_design
+
+# HDL wrapper
+make_wrapper -files [get_files $Design.bd] -top
+add_files -norecurse [glob $TopDir/$Project/$Project.gen/sources_1/bd/$Design/hdl/${Design}_wrapper.v]
+set_property top ${Design}_wrapper [current_fileset]
+
+#exit
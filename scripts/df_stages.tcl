@@ -0,0 +1,47 @@
+##
+# @file df_stages.tcl
+# @brief Settings of the processes of the dataflow decimator (ssr_multistage_decimator_df).
+#        Sourced by run.tcl (dataflow top), run_stage.tcl (per-stage synthesis) and compose_stages.tcl.
+#
+##
+
+# Processes, in pipeline order
+set StageList {df_input df_dec2_ssr8 df_dec2_ssr4 df_dec2_ssr2 df_dec16 df_dec32 df_dec64 df_output}
+
+# Initiation interval of each process, given by its input sample rate:
+# the lower-rate stages accept a new input every 2 or 4 clock cycles and share the multipliers
+set StageII [dict create \
+    df_input     1 \
+    df_dec2_ssr8 1 \
+    df_dec2_ssr4 1 \
+    df_dec2_ssr2 1 \
+    df_dec16     1 \
+    df_dec32     2 \
+    df_dec64     4 \
+    df_output    1 ]
+
+# DSP pumping factor of each process, for the per-stage synthesis only (run_stage.tcl, compose_stages.tcl):
+# a process with pump factor k runs in a clock domain k times faster than ap_clk with an initiation interval k times
+# larger, so it keeps the same throughput and every multiplier is time-shared by k products (1, 2 or 4).
+# The streams to and from the other clock domains cross through clock converters in the block design.
+# Intended for the SSR stages, which need one multiplier per product at II = 1.
+set StagePump [dict create \
+    df_input     1 \
+    df_dec2_ssr8 1 \
+    df_dec2_ssr4 1 \
+    df_dec2_ssr2 1 \
+    df_dec16     1 \
+    df_dec32     1 \
+    df_dec64     1 \
+    df_output    1 ]
+
+# Stream ports of each process
+set StagePorts [dict create \
+    df_input     {tdata_i phase_reset_i tdata_o tap_o} \
+    df_dec2_ssr8 {tdata_i tdata_o tap_o} \
+    df_dec2_ssr4 {tdata_i tdata_o tap_o} \
+    df_dec2_ssr2 {tdata_i tdata_o tap_o} \
+    df_dec16     {tdata_i tdata_o tap_o} \
+    df_dec32     {tdata_i tdata_o tap_o} \
+    df_dec64     {tdata_i tap_o} \
+    df_output    {tap_dec1 tap_dec2 tap_dec4 tap_dec8 tap_dec16 tap_dec32 tap_dec64 tdata_o sample_index_o} ]
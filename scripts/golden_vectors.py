@@ -0,0 +1,92 @@
+"""
+Reference vectors of the software models (data/golden).
+
+The software models (sw/) are checked against the C-simulation of the HLS design for every decimation factor:
+the stimulus is data/golden/input_test_vector.txt (same format as the test cases, 8 complex samples per line) and
+the reference output of the decimation factor d is data/golden/output_dec<d>.txt, one complex sample per line
+(the valid samples of the C-simulation output, in the format of output_sw.txt).
+
+The stimulus is deterministic: an in-band and an out-of-band complex tone, uniform noise, and a final burst of a
+square wave at full scale (the stage outputs exceed the full scale and wrap around, as the s16.15 data type).
+
+Usage:
+  python3 golden_vectors.py input <file>                               write the stimulus
+  python3 golden_vectors.py extract <output_csim.txt> <dec_factor> <file>  valid samples of a C-simulation output
+
+To regenerate the reference output, run the C-simulation of the default build (run_csim.tcl) with the stimulus
+in data/work for each decimation factor, then extract work/output_csim.txt.
+"""
+
+import argparse
+import math
+
+# input samples per line (SSR of the hardware)
+ssr = 8
+# input words of the stimulus, and words of the final full-scale burst
+num_words = 512
+burst_words = 64
+
+# full scale of the s16.15 input samples
+full_scale = 1 << 15
+
+
+def stimulus():
+    samples = []
+    state = 12345
+    for n in range(num_words * ssr):
+        # linear congruential generator (same constants as the HLS testbench)
+        state = (state * 1664525 + 1013904223) & 0xFFFFFFFF
+        noise_re = ((state >> 8) & 0xFFFF) / 65536.0 - 0.5
+        state = (state * 1664525 + 1013904223) & 0xFFFFFFFF
+        noise_im = ((state >> 8) & 0xFFFF) / 65536.0 - 0.5
+        if n < (num_words - burst_words) * ssr:
+            x = 0.35 * complex(math.cos(2 * math.pi * 0.003 * n), math.sin(2 * math.pi * 0.003 * n))
+            x += 0.3 * complex(math.cos(2 * math.pi * 0.37 * n), math.sin(2 * math.pi * 0.37 * n))
+            x += 0.2 * complex(noise_re, noise_im)
+        else:
+            # square wave: the stage outputs exceed the full scale
+            x = complex(1 if (n // 96) % 2 else -1, -1 if (n // 160) % 2 else 1)
+        re = max(-full_scale, min(full_scale - 1, int(round(x.real * full_scale))))
+        im = max(-full_scale, min(full_scale - 1, int(round(x.imag * full_scale))))
+        samples.append((re, im))
+    return samples
+
+
+def write_input(file_name):
+    samples = stimulus()
+    with open(file_name, 'w') as f:
+        for w in range(num_words):
+            f.write(' '.join('%d %d' % s for s in samples[w * ssr:(w + 1) * ssr]) + '\n')
+
+
+def extract(csim_file, dec_factor, file_name):
+    # valid lanes of the output word: 8 / d for d <= 8, one above
+    lanes = ssr // dec_factor if dec_factor < ssr else 1
+    with open(csim_file) as f, open(file_name, 'w') as g:
+        for line in f:
+            v = [int(x) for x in line.split()]
+            if not v or v[0] == 0:
+                continue
+            for i in range(lanes):
+                g.write('%d %d\n' % (v[1 + 2 * i], v[2 + 2 * i]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='reference vectors of the software models')
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('input', help='write the stimulus')
+    p.add_argument('file')
+    p = sub.add_parser('extract', help='valid samples of a C-simulation output')
+    p.add_argument('csim_file')
+    p.add_argument('dec_factor', type=int)
+    p.add_argument('file')
+    args = parser.parse_args()
+
+    if args.command == 'input':
+        write_input(args.file)
+    else:
+        extract(args.csim_file, args.dec_factor, args.file)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,176 @@
+"""
+Stopband attenuation of the half-band prototype filter vs. coefficient word length.
+
+Designs the equiripple half-band prototype (Remez exchange on the odd taps, same specification as
+matlab/dec_filter_design.m: Fs = 1280 MHz, Fstop = 390 MHz, order 30), quantizes the coefficients to
+s<bits>.<bits - 1> (round to nearest) and reports the stopband attenuation and the passband ripple for each
+word length. The 18-bit coefficients of the MATLAB design (data/hbFilter.coe) are reported as reference.
+
+With --header, writes the prototype coefficient tables used by the hardware (hw/src/hbf_coefs.h):
+the 18-bit table is the MATLAB design (bit-exact with the reference model), the 24 and 27-bit tables
+(DSP58 multiplier ports) are the Remez design.
+
+Usage: python3 hbf_coef_bits.py [--order N] [--bits 12,14,...] [--header <file>]
+"""
+
+import argparse
+import math
+import os
+
+# filter specification (see matlab/dec_filter_design.m)
+fs = 1280e6
+fpass = 250e6
+fstop = 390e6
+
+# word lengths of the hardware tables (COEF_BITS)
+header_bits = [18, 24, 27]
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+coe_file = os.path.join(script_dir, '..', 'data', 'hbFilter.coe')
+
+
+# Function to solve the linear system A x = b (Gauss-Jordan elimination with partial pivoting)
+def solve(A, b):
+    n = len(b)
+    M = [row[:] + [b[i]] for i, row in enumerate(A)]
+    for c in range(n):
+        p = max(range(c, n), key=lambda r: abs(M[r][c]))
+        M[c], M[p] = M[p], M[c]
+        for r in range(n):
+            if r != c:
+                f = M[r][c] / M[c][c]
+                for k in range(c, n + 1):
+                    M[r][k] -= f * M[c][k]
+    return [M[i][n] / M[i][i] for i in range(n)]
+
+
+# Function to design the equiripple half-band filter of the given order (order = 4 K - 2)
+# H(w) = 1/2 + sum_k b_k cos((2 k + 1) w), the b_k minimize the maximum of |H(w)| in the stopband
+def design(order, grid=20000):
+    K = (order + 2) // 4
+    ws = 2 * math.pi * fstop / fs
+    W = [ws + (math.pi - ws) * i / (grid - 1) for i in range(grid)]
+    ext = [W[int(i * (grid - 1) / K)] for i in range(K + 1)]
+    for _ in range(100):
+        A = [[math.cos((2 * k + 1) * w) for k in range(K)] + [(-1) ** i] for i, w in enumerate(ext)]
+        b = solve(A, [-0.5] * (K + 1))[:K]
+        E = [0.5 + sum(b[k] * math.cos((2 * k + 1) * w) for k in range(K)) for w in W]
+        # alternating extrema of the error (band edges included)
+        idx = [0] + [i for i in range(1, grid - 1) if (E[i] - E[i - 1]) * (E[i + 1] - E[i]) <= 0] + [grid - 1]
+        alt = []
+        for i in idx:
+            if alt and (E[i] > 0) == (E[alt[-1]] > 0):
+                if abs(E[i]) > abs(E[alt[-1]]):
+                    alt[-1] = i
+            else:
+                alt.append(i)
+        while len(alt) > K + 1:
+            alt.pop(0 if abs(E[alt[0]]) < abs(E[alt[-1]]) else -1)
+        new = [W[i] for i in alt]
+        if new == ext:
+            break
+        ext = new
+    h = [0.0] * (order + 1)
+    c = order // 2
+    h[c] = 0.5
+    for k in range(K):
+        h[c + 2 * k + 1] = h[c - 2 * k - 1] = b[k] / 2
+    return h
+
+
+# Function to quantize the coefficients to s<bits>.<bits - 1> integers (round to nearest)
+def quantize(h, bits):
+    return [int(math.floor(x * 2 ** (bits - 1) + 0.5)) for x in h]
+
+
+# Function to compute the magnitude response at frequency f
+def response(h, f):
+    w = 2 * math.pi * f / fs
+    c = (len(h) - 1) / 2
+    return abs(sum(x * math.cos(w * (n - c)) for n, x in enumerate(h)))
+
+
+# Function to measure the stopband attenuation (dB) and the passband ripple (dB peak-to-peak)
+def measure(h, points=4000):
+    dc = response(h, 0)
+    stop = max(response(h, fstop + (fs / 2 - fstop) * i / points) for i in range(points + 1))
+    band = [20 * math.log10(response(h, fpass * i / points)) for i in range(points + 1)]
+    return -20 * math.log10(stop / dc), max(band) - min(band)
+
+
+# Function to read the 18-bit coefficients of the MATLAB design
+def read_coe(file):
+    with open(file) as f:
+        text = f.read().split('coefdata=')[1]
+    return [int(v) for v in text.replace(';', ',').replace('\n', '').split(',') if v.strip() != '']
+
+
+# Function to write the prototype coefficient tables
+def write_header(file, tables):
+    lines = [
+        '/**',
+        ' * @file hbf_coefs.h',
+        ' * @brief prototype half-band filter coefficients, one table per coefficient word length (COEF_BITS)',
+        ' *',
+        ' * @details',
+        ' *  Generated by scripts/hbf_coef_bits.py - do not edit.',
+        ' *  The coefficients are s<COEF_BITS>.<COEF_BITS - 1> integers (the center tap 0.5 is 2^(COEF_BITS - 2)),',
+        ' *  constexpr so that the widths of the datapath can be derived from them (see ssr_multistage_decimator.h).',
+        ' *  - 18 bits: MATLAB design (data/hbFilter.coe, matlab/dec_filter_design.m)',
+        ' *  - 24, 27 bits: equiripple design of scripts/hbf_coef_bits.py (same specification)',
+        ' *',
+        ' * @author marco.pausini@gmail.com',
+        ' * @date 2023-11-xy',
+        ' * @version 0.1',
+        ' *',
+        ' */',
+        '',
+        '#ifndef HBF_COEFS_H_',
+        '#define HBF_COEFS_H_',
+        '',
+        f'constexpr int hbf_num_taps = {len(tables[header_bits[0]])};',
+        '',
+    ]
+    for i, bits in enumerate(header_bits):
+        lines.append(f'#{"if" if i == 0 else "elif"} COEF_BITS == {bits}')
+        lines.append('constexpr int hbf_coef[hbf_num_taps] = {' + ', '.join(str(v) for v in tables[bits]) + '};')
+    lines += ['#endif', '', '#endif /* HBF_COEFS_H_ */', '']
+    with open(file, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Half-band prototype attenuation vs. coefficient word length')
+    parser.add_argument('--order', type=int, default=30, help='filter order (4 K - 2)')
+    parser.add_argument('--bits', default='12,14,16,18,20,22,24,27', help='coefficient word lengths')
+    parser.add_argument('--header', help='write the hardware coefficient tables (order 30 only)')
+    args = parser.parse_args()
+
+    if (args.order + 2) % 4 != 0:
+        parser.error('the order of a half-band filter must be 4 K - 2')
+
+    h = design(args.order)
+    att, rip = measure(h)
+    print(f'order {args.order}, Fpass {fpass / 1e6:g} MHz, Fstop {fstop / 1e6:g} MHz, Fs {fs / 1e6:g} MHz')
+    print(f'{"bits":>8} {"Ast [dB]":>10} {"Ap [dB]":>10}')
+    print(f'{"double":>8} {att:10.2f} {rip:10.5f}')
+    for bits in [int(b) for b in args.bits.split(',')]:
+        att, rip = measure([v / 2 ** (bits - 1) for v in quantize(h, bits)])
+        print(f'{bits:>8} {att:10.2f} {rip:10.5f}')
+
+    coe = read_coe(coe_file)
+    if len(coe) == args.order + 1:
+        att, rip = measure([v / 2 ** 17 for v in coe])
+        print(f'{"18 (coe)":>8} {att:10.2f} {rip:10.5f}')
+
+    if args.header:
+        if args.order != 30:
+            parser.error('the hardware tables are order 30')
+        tables = {bits: quantize(h, bits) for bits in header_bits}
+        tables[18] = coe
+        write_header(args.header, tables)
+        print(f'written {args.header}')
+
+
+if __name__ == '__main__':
+    main()
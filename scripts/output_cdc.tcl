@@ -0,0 +1,46 @@
+##
+# @file output_cdc.tcl
+# @brief Sizing of the clock-domain-crossing (CDC) FIFO between the decimator output and a slower consumer clock.
+#        Sourced by compose_stages.tcl.
+#
+# The output stream of the decimator carries one word (ssr lanes) per valid output:
+#   - dec_factor 1..8:  one word per processing clock cycle (8, 4, 2, 1 valid lanes)
+#   - dec_factor 16..64: one word every dec_factor / 8 processing clock cycles
+# The consumer clock never applies backpressure if it reads the words faster than they are written:
+#   f_out >= rate(dec_factor) * f_proc * (1 + margin)
+# Then the FIFO only holds the words written while the read side synchronizes the write pointer
+# (SyncStages consumer clock cycles, plus the register stages of the FIFO).
+#
+##
+
+# number of synchronization stages of the async FIFO
+set SyncStages 3
+# clock frequency margin (e.g. clock tolerances)
+set ClockMargin 0.05
+
+# output words per processing clock cycle
+proc output_word_rate {dec_factor} {
+    if {$dec_factor <= 8} {
+        return 1.0
+    }
+    return [expr {8.0 / $dec_factor}]
+}
+
+# minimum consumer clock frequency (MHz) with no backpressure for the decimation factors >= min_dec_factor
+proc min_output_clock {proc_clock min_dec_factor} {
+    global ClockMargin
+    return [expr {[output_word_rate $min_dec_factor] * $proc_clock * (1.0 + $ClockMargin)}]
+}
+
+# depth of the CDC FIFO: words written during the CDC latency of the read side (plus the FIFO register stages),
+# doubled and rounded up to a power of 2, at least 16 (minimum depth of axis_data_fifo)
+proc cdc_fifo_depth {proc_clock out_clock min_dec_factor} {
+    global SyncStages
+    set latency [expr {($SyncStages + 2) * $proc_clock / double($out_clock)}]
+    set words [expr {int(ceil([output_word_rate $min_dec_factor] * $latency)) + 1}]
+    set depth 16
+    while {$depth < 2 * $words} {
+        set depth [expr {2 * $depth}]
+    }
+    return $depth
+}
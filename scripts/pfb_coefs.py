@@ -0,0 +1,161 @@
+"""
+Prototype low-pass filter of the polyphase filter bank channelizer (ssr_multistage_decimator_pfb).
+
+Designs the prototype of an M-channel critically sampled filter bank (M = 16 or 32 channels of fs / M):
+Kaiser-windowed sinc, taps_per_branch x M taps, cut-off fs / (2 M) (-6 dB at the channel edge, the adjacent
+channels cross at -6 dB), DC gain 1. The coefficients are scaled by M / 2 (largest coefficient about 0.5) and quantized
+to s<bits>.<bits - 1> (round to nearest); the channelizer divides the FFT output by M / 2.
+Reports the gain at the channel edge and the attenuation from the center of the adjacent channel (fs / M) to fs / 2.
+
+With --header, writes the coefficient tables used by the hardware (hw/src/pfb_coefs.h), one per number of
+channels (PFB_CHANNELS) and coefficient word length (COEF_BITS), and the twiddle factors W_M^(j q) of the SSR FFT
+(lane j = 0 .. 7 of the output word q = 0 .. M / 8 - 1, s18.16).
+
+Usage: python3 pfb_coefs.py [--beta B] [--bits 12,14,...] [--header <file>]
+"""
+
+import argparse
+import math
+
+# filter bank specification
+channels = [16, 32]
+taps_per_branch = 8
+
+# word lengths of the hardware tables (COEF_BITS)
+header_bits = [18, 24, 27]
+
+# SSR of the hardware (input samples per word) and fractional bits of the twiddle factors (s18.16)
+ssr = 8
+twiddle_fractional_bits = 16
+
+
+# Function to compute the zeroth order modified Bessel function of the first kind (power series)
+def bessel_i0(x):
+    s, t, k = 1.0, 1.0, 1
+    while t > 1e-12 * s:
+        t *= (x / (2 * k)) ** 2
+        s += t
+        k += 1
+    return s
+
+
+# Function to design the prototype filter of an M-channel filter bank (DC gain 1)
+def design(M, beta):
+    N = taps_per_branch * M
+    c = (N - 1) / 2
+    h = []
+    for n in range(N):
+        t = n - c
+        sinc = 1 / M if t == 0 else math.sin(math.pi * t / M) / (math.pi * t)
+        w = bessel_i0(beta * math.sqrt(1 - (2 * t / (N - 1)) ** 2)) / bessel_i0(beta)
+        h.append(sinc * w)
+    dc = sum(h)
+    return [x / dc for x in h]
+
+
+# Function to quantize the coefficients scaled by M / 2 to s<bits>.<bits - 1> integers (round to nearest)
+def quantize(h, M, bits):
+    return [int(math.floor(x * M / 2 * 2 ** (bits - 1) + 0.5)) for x in h]
+
+
+# Function to compute the magnitude response at the normalized frequency f (cycles per sample)
+def response(h, f):
+    w = 2 * math.pi * f
+    c = (len(h) - 1) / 2
+    return abs(sum(x * math.cos(w * (n - c)) for n, x in enumerate(h)))
+
+
+# Function to measure the gain at the channel edge (dB) and the attenuation beyond the adjacent channel center (dB)
+def measure(h, M, points=2000):
+    dc = response(h, 0)
+    edge = response(h, 0.5 / M)
+    stop = max(response(h, 1 / M + (0.5 - 1 / M) * i / points) for i in range(points + 1))
+    return 20 * math.log10(edge / dc), -20 * math.log10(stop / dc)
+
+
+# Function to compute the twiddle factors W_M^(j q) = exp(-j 2 pi j q / M) of the SSR FFT (s18.16 integers)
+def twiddles(M):
+    scale = 2 ** twiddle_fractional_bits
+    re = [[int(math.floor(math.cos(2 * math.pi * j * q / M) * scale + 0.5)) for j in range(ssr)] for q in range(M // ssr)]
+    im = [[int(math.floor(-math.sin(2 * math.pi * j * q / M) * scale + 0.5)) for j in range(ssr)] for q in range(M // ssr)]
+    return re, im
+
+
+# Function to format a 2D table
+def table_2d(rows):
+    return '{' + ', '.join('{' + ', '.join(str(v) for v in row) + '}' for row in rows) + '}'
+
+
+# Function to write the coefficient tables
+def write_header(file, tables, beta):
+    lines = [
+        '/**',
+        ' * @file pfb_coefs.h',
+        ' * @brief prototype filter coefficients of the polyphase filter bank channelizer, one table per number of',
+        ' *        channels (PFB_CHANNELS) and coefficient word length (COEF_BITS)',
+        ' *',
+        ' * @details',
+        ' *  Generated by scripts/pfb_coefs.py - do not edit.',
+        f' *  Kaiser-windowed sinc (beta = {beta:g}), pfb_taps_per_branch x PFB_CHANNELS taps, cut-off fs / (2 PFB_CHANNELS).',
+        ' *  The coefficients are scaled by PFB_CHANNELS / 2 and are s<COEF_BITS>.<COEF_BITS - 1> integers.',
+        ' *  The twiddle factors of the SSR FFT, W_M^(j q) = exp(-j 2 pi j q / M) for the lane j of the output word q,',
+        ' *  are s18.16 integers.',
+        ' *',
+        ' * @author marco.pausini@gmail.com',
+        ' * @date 2023-11-xy',
+        ' * @version 0.1',
+        ' *',
+        ' */',
+        '',
+        '#ifndef PFB_COEFS_H_',
+        '#define PFB_COEFS_H_',
+        '',
+        f'constexpr int pfb_taps_per_branch = {taps_per_branch};',
+        'constexpr int pfb_num_taps = pfb_taps_per_branch * PFB_CHANNELS;',
+        '',
+    ]
+    first = True
+    for M in channels:
+        for bits in header_bits:
+            lines.append(f'#{"if" if first else "elif"} PFB_CHANNELS == {M} && COEF_BITS == {bits}')
+            lines.append('constexpr int pfb_coef[pfb_num_taps] = {' + ', '.join(str(v) for v in tables[(M, bits)]) + '};')
+            first = False
+    lines += ['#endif', '']
+    for i, M in enumerate(channels):
+        re, im = twiddles(M)
+        lines.append(f'#{"if" if i == 0 else "elif"} PFB_CHANNELS == {M}')
+        lines.append(f'constexpr int pfb_twiddle_re[PFB_CHANNELS / {ssr}][{ssr}] = {table_2d(re)};')
+        lines.append(f'constexpr int pfb_twiddle_im[PFB_CHANNELS / {ssr}][{ssr}] = {table_2d(im)};')
+    lines += ['#endif', '', '#endif /* PFB_COEFS_H_ */', '']
+    with open(file, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Prototype filter of the polyphase filter bank channelizer')
+    parser.add_argument('--beta', type=float, default=8.0, help='Kaiser window parameter')
+    parser.add_argument('--bits', default='12,14,16,18,24,27', help='coefficient word lengths')
+    parser.add_argument('--header', help='write the hardware coefficient tables')
+    args = parser.parse_args()
+
+    tables = {}
+    for M in channels:
+        h = design(M, args.beta)
+        edge, att = measure(h, M)
+        print(f'{M} channels, {len(h)} taps, beta {args.beta:g}')
+        print(f'{"bits":>8} {"edge [dB]":>10} {"Ast [dB]":>10}')
+        print(f'{"double":>8} {edge:10.2f} {att:10.2f}')
+        for bits in [int(b) for b in args.bits.split(',')]:
+            q = quantize(h, M, bits)
+            edge, att = measure([v / (M / 2 * 2 ** (bits - 1)) for v in q], M)
+            print(f'{bits:>8} {edge:10.2f} {att:10.2f}')
+        for bits in header_bits:
+            tables[(M, bits)] = quantize(h, M, bits)
+
+    if args.header:
+        write_header(args.header, tables, args.beta)
+        print(f'written {args.header}')
+
+
+if __name__ == '__main__':
+    main()
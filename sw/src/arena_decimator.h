@@ -0,0 +1,223 @@
+/**
+ * @file arena_decimator.h
+ * @brief Multistage decimator software model working in a caller-provided memory arena.
+ *
+ * @details
+ *  Zero-allocation version of simd_decimator for real-time host processing: the number of channels is set
+ *  at run time and all the working memory (delay lines of the stages, accumulators, output staging) lives in
+ *  an arena provided by the caller, sized by required_memory(dec_factor, channels).
+ *  The decimator never allocates memory: init() only lays out the arena, process() and process_sc16()
+ *  run in constant time per input frame.
+ *
+ *  Same stage kernel and frame layout as simd_decimator (bit-exact with ssr_multistage_decimator, hw/src,
+ *  built with the same compile-time options), with a run-time number of channels:
+ *  the loops over the channels are the innermost loops, each channel runs the full cascade of stages.
+ *
+ *  Arena layout (each block aligned to arena_alignment bytes):
+ *  - for each stage: delay line re, im  int32[2 * hbf_num_coef * channels] (circular buffer stored twice)
+ *  - accumulators re, im                int64[channels]
+ *  - output staging re, im              int32[channels]
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef ARENA_DECIMATOR_H_
+#define ARENA_DECIMATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd_decimator.h"
+
+// alignment of the arena blocks (cache line)
+constexpr std::size_t arena_alignment = 64;
+
+/**
+ * @brief round a size up to a multiple of arena_alignment
+ */
+inline std::size_t arena_align(std::size_t size)
+{
+    return (size + arena_alignment - 1) & ~(arena_alignment - 1);
+}
+
+/**
+ * @brief size in bytes of the arena for a decimation factor and a number of channels, 0 if not supported
+ *
+ * The size includes the padding to align an arena that starts at any address.
+ */
+inline std::size_t required_memory(int dec_factor, int channels)
+{
+    int num_stages = num_stages_of(dec_factor);
+    if (num_stages < 0 || channels <= 0)
+    {
+        return 0;
+    }
+    std::size_t n = static_cast<std::size_t>(channels);
+    std::size_t delay_line = arena_align(2 * hbf_num_coef * n * sizeof(int32_t));
+    std::size_t acc = arena_align(n * sizeof(int64_t));
+    std::size_t staging = arena_align(n * sizeof(int32_t));
+    return arena_alignment - 1 + num_stages * 2 * delay_line + 2 * acc + 2 * staging;
+}
+
+/**
+ * @brief multistage decimator, any number of channels, state in a caller-provided arena
+ */
+class arena_decimator
+{
+public:
+    /**
+     * @brief lay out the arena and reset the filters
+     *
+     * @param arena       caller-provided memory, must outlive the decimator
+     * @param arena_size  size of the arena in bytes, at least required_memory(dec_factor, channels)
+     * @return false if the configuration is not supported or the arena is too small
+     */
+    bool init(void *arena, std::size_t arena_size, int dec_factor, int channels)
+    {
+        std::size_t size = required_memory(dec_factor, channels);
+        if (arena == nullptr || size == 0 || arena_size < size)
+        {
+            return false;
+        }
+        num_stages = num_stages_of(dec_factor);
+        num_channels = channels;
+
+        std::uintptr_t ptr = arena_align(reinterpret_cast<std::uintptr_t>(arena));
+        std::size_t n = static_cast<std::size_t>(channels);
+        for (int s = 0; s < num_stages; ++s)
+        {
+            stage[s].buf_re = take<int32_t>(ptr, 2 * hbf_num_coef * n);
+            stage[s].buf_im = take<int32_t>(ptr, 2 * hbf_num_coef * n);
+            stage[s].fs4_shift = (s < 2) ? stage_fs4_shift[s] : 0;
+        }
+        acc_re = take<int64_t>(ptr, n);
+        acc_im = take<int64_t>(ptr, n);
+        x_re = take<int32_t>(ptr, n);
+        x_im = take<int32_t>(ptr, n);
+
+        reset();
+        return true;
+    }
+
+    int dec_factor() const
+    {
+        return 1 << num_stages;
+    }
+
+    int channels() const
+    {
+        return num_channels;
+    }
+
+    /**
+     * @brief clear the state of the filters
+     */
+    void reset()
+    {
+        for (int s = 0; s < num_stages; ++s)
+        {
+            hbf_stage_reset(stage[s], num_channels);
+        }
+    }
+
+    /**
+     * @brief reset the decimation phase, as the phase reset of the HLS design (phase_reset_i, see decimator_taps):
+     *        every stage keeps the next input frame, so it produces an output frame (the filter state is kept)
+     */
+    void phase_reset()
+    {
+        for (int s = 0; s < num_stages; ++s)
+        {
+            stage[s].skip = false;
+        }
+    }
+
+    /**
+     * @brief decimate num_frames input frames
+     *
+     * @param in_re, in_im    input frames, in_re[n * channels + c]
+     * @param num_frames      number of input frames
+     * @param out_re, out_im  output frames, room for num_frames / dec_factor + 1 frames
+     * @return number of output frames
+     */
+    std::size_t process(const int16_t *in_re, const int16_t *in_im, std::size_t num_frames, int16_t *out_re, int16_t *out_im)
+    {
+        const int C = num_channels;
+        std::size_t num_out = 0;
+        for (std::size_t n = 0; n < num_frames; ++n)
+        {
+            for (int c = 0; c < C; ++c)
+            {
+                x_re[c] = in_re[n * C + c];
+                x_im[c] = in_im[n * C + c];
+            }
+
+            if (run_cascade())
+            {
+                for (int c = 0; c < C; ++c)
+                {
+                    out_re[num_out * C + c] = static_cast<int16_t>(x_re[c]);
+                    out_im[num_out * C + c] = static_cast<int16_t>(x_im[c]);
+                }
+                num_out++;
+            }
+        }
+        return num_out;
+    }
+
+    /**
+     * @brief decimate num_frames input frames of interleaved SC16 samples (same layout as simd_decimator)
+     *
+     * @param in_iq       input frames, I/Q of channel c of frame n at in_iq[2 * (n * channels + c)], in_iq[2 * (n * channels + c) + 1]
+     * @param num_frames  number of input frames
+     * @param out_iq      output frames, same layout, room for num_frames / dec_factor + 1 frames
+     * @return number of output frames
+     */
+    std::size_t process_sc16(const int16_t *in_iq, std::size_t num_frames, int16_t *out_iq)
+    {
+        const std::size_t C = num_channels;
+        std::size_t num_out = 0;
+        for (std::size_t n = 0; n < num_frames; ++n)
+        {
+            // deinterleaved straight into the delay line of the first stage
+            if (hbf_cascade_push_sc16(stage, num_stages, num_channels, in_iq + 2 * n * C, x_re, x_im, acc_re, acc_im))
+            {
+                sc16_interleave(x_re, x_im, C, out_iq + 2 * num_out * C);
+                num_out++;
+            }
+        }
+        return num_out;
+    }
+
+private:
+    template <typename T>
+    static T *take(std::uintptr_t &ptr, std::size_t count)
+    {
+        T *block = reinterpret_cast<T *>(ptr);
+        ptr += arena_align(count * sizeof(T));
+        return block;
+    }
+
+    /**
+     * @brief run the staged frame through the cascade (see hbf_cascade_push)
+     * @return true if the last stage produced an output frame (written back to x_re, x_im, quantized to DATAOUT_BITS)
+     */
+    bool run_cascade()
+    {
+        return hbf_cascade_push(stage, num_stages, num_channels, x_re, x_im, acc_re, acc_im);
+    }
+
+    // half-band stages, delay lines in the arena
+    hbf_stage stage[max_num_stages];
+    int64_t *acc_re = nullptr;
+    int64_t *acc_im = nullptr;
+    int32_t *x_re = nullptr;
+    int32_t *x_im = nullptr;
+    int num_stages = 0;
+    int num_channels = 0;
+};
+
+#endif /* ARENA_DECIMATOR_H_ */
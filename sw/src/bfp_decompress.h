@@ -0,0 +1,74 @@
+/**
+ * @file bfp_decompress.h
+ * @brief Host decompressor of the block floating point (BFP) output of ssr_multistage_decimator_bfp.
+ *
+ * @details
+ *  Each output block carries ssr = 8 complex samples sharing one exponent (see hw/src/bfp_compress.h).
+ *  The block is packed LSB first on the output bus, and stored little-endian in memory (see bitstream.h):
+ *  - exponent e:  bits [7:0]
+ *  - re[i]:       m bits starting at bit 8 + i m,       i = 0..7 (two's complement mantissa)
+ *  - im[i]:       m bits starting at bit 8 + (8 + i) m, i = 0..7
+ *  so a block takes 1 + 2 m bytes (17, 21, 25 bytes for m = 8, 10, 12).
+ *
+ *  The decompressed sample is mantissa << e (s16.15), bit-exact with the hardware.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef BFP_DECOMPRESS_H_
+#define BFP_DECOMPRESS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitstream.h"
+
+// number of complex samples per BFP block
+constexpr int bfp_block_samples = 8;
+// exponent field bits
+constexpr int bfp_exp_field_bits = 8;
+
+/**
+ * @brief size in bytes of a BFP block with mant_bits mantissas
+ */
+inline std::size_t bfp_block_bytes(int mant_bits)
+{
+    return (bfp_exp_field_bits + 2 * bfp_block_samples * mant_bits + 7) / 8;
+}
+
+/**
+ * @brief decompress num_blocks BFP blocks
+ *
+ * @param blocks      compressed blocks, bfp_block_bytes(mant_bits) bytes each
+ * @param num_blocks  number of blocks
+ * @param mant_bits   mantissa bits (8, 10 or 12, BFP_MANTISSA_BITS of the hardware)
+ * @param out_iq      decompressed samples (SC16), bfp_block_samples samples per block
+ * @return false if mant_bits is not supported
+ */
+inline bool bfp_decompress(const uint8_t *blocks, std::size_t num_blocks, int mant_bits, int16_t *out_iq)
+{
+    if (mant_bits != 8 && mant_bits != 10 && mant_bits != 12)
+    {
+        return false;
+    }
+    const std::size_t block_bytes = bfp_block_bytes(mant_bits);
+    for (std::size_t n = 0; n < num_blocks; ++n)
+    {
+        const uint8_t *block = blocks + n * block_bytes;
+        const int exp = static_cast<int>(read_bits_le(block, 0, bfp_exp_field_bits));
+        for (int k = 0; k < 2 * bfp_block_samples; ++k)
+        {
+            // k = 0..7: re[k], k = 8..15: im[k - 8]
+            uint32_t field = read_bits_le(block, bfp_exp_field_bits + k * mant_bits, mant_bits);
+            int32_t mant = sign_extend(field, mant_bits);
+            int i = k % bfp_block_samples;
+            out_iq[2 * (n * bfp_block_samples + i) + k / bfp_block_samples] = static_cast<int16_t>(mant * (1 << exp));
+        }
+    }
+    return true;
+}
+
+#endif /* BFP_DECOMPRESS_H_ */
@@ -0,0 +1,43 @@
+/**
+ * @file bitstream.h
+ * @brief Bit-field access to the packed output words of the decimator.
+ *
+ * @details
+ *  The hardware packs the fields of an output word on the bus LSB first (AGGREGATE compact=bit),
+ *  and the DMA stores the word little-endian in memory: bit pos of the word is bit (pos % 8) of byte pos / 8.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef BITSTREAM_H_
+#define BITSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief read a bits-wide field at bit offset pos of a little-endian bit stream (bits <= 25)
+ */
+inline uint32_t read_bits_le(const uint8_t *data, std::size_t pos, int bits)
+{
+    const int shift = static_cast<int>(pos % 8);
+    uint32_t word = 0;
+    for (int b = 0; 8 * b < shift + bits; ++b)
+    {
+        word |= static_cast<uint32_t>(data[pos / 8 + b]) << (8 * b);
+    }
+    return (word >> shift) & ((1u << bits) - 1);
+}
+
+/**
+ * @brief sign-extend a bits-wide two's complement field
+ */
+inline int32_t sign_extend(uint32_t field, int bits)
+{
+    return static_cast<int32_t>(field << (32 - bits)) >> (32 - bits);
+}
+
+#endif /* BITSTREAM_H_ */
@@ -0,0 +1,70 @@
+/**
+ * @file packed_samples.h
+ * @brief Host unpacking of the packed 12-bit and 8-bit output samples of the decimator.
+ *
+ * @details
+ *  With DATAOUT_BITS = B (12 or 8) the output samples are rounded (AP_RND_INF) and saturated (AP_SAT)
+ *  to sB.(B-1) and packed on the output bus without padding (see bitstream.h):
+ *  - re[i]:  B bits starting at bit i B,       i = 0..7
+ *  - im[i]:  B bits starting at bit (8 + i) B, i = 0..7
+ *  so an output word (beat) takes 2 B bytes (24 bytes for B = 12, 16 bytes for B = 8, 32 bytes for B = 16).
+ *
+ *  unpack_samples returns the samples as SC16 in s16.15 format (the B-bit value shifted left by 16 - B),
+ *  i.e. with the same scale as the 16-bit output.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef PACKED_SAMPLES_H_
+#define PACKED_SAMPLES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitstream.h"
+
+// number of complex samples per output word
+constexpr int packed_beat_samples = 8;
+
+/**
+ * @brief size in bytes of an output word with sample_bits samples
+ */
+inline std::size_t packed_beat_bytes(int sample_bits)
+{
+    return (2 * packed_beat_samples * sample_bits + 7) / 8;
+}
+
+/**
+ * @brief unpack num_beats output words
+ *
+ * @param beats        packed output words, packed_beat_bytes(sample_bits) bytes each
+ * @param num_beats    number of output words
+ * @param sample_bits  bits per sample (16, 12 or 8, DATAOUT_BITS of the hardware)
+ * @param out_iq       samples (SC16, s16.15), packed_beat_samples samples per word
+ * @return false if sample_bits is not supported
+ */
+inline bool unpack_samples(const uint8_t *beats, std::size_t num_beats, int sample_bits, int16_t *out_iq)
+{
+    if (sample_bits != 16 && sample_bits != 12 && sample_bits != 8)
+    {
+        return false;
+    }
+    const std::size_t beat_bytes = packed_beat_bytes(sample_bits);
+    for (std::size_t n = 0; n < num_beats; ++n)
+    {
+        const uint8_t *beat = beats + n * beat_bytes;
+        for (int k = 0; k < 2 * packed_beat_samples; ++k)
+        {
+            // k = 0..7: re[k], k = 8..15: im[k - 8]
+            int32_t value = sign_extend(read_bits_le(beat, k * sample_bits, sample_bits), sample_bits);
+            int i = k % packed_beat_samples;
+            out_iq[2 * (n * packed_beat_samples + i) + k / packed_beat_samples] = static_cast<int16_t>(value * (1 << (16 - sample_bits)));
+        }
+    }
+    return true;
+}
+
+#endif /* PACKED_SAMPLES_H_ */
@@ -0,0 +1,96 @@
+/**
+ * @file sc16_adapter.h
+ * @brief Conversion between interleaved SC16 samples and the split re/im buffers of the software models.
+ *
+ * @details
+ *  Capture files and DMA buffers store complex samples as interleaved 16-bit I/Q pairs (SC16):
+ *  iq[2 * n] = I(n), iq[2 * n + 1] = Q(n), i.e. one complex sample per little-endian 32-bit word.
+ *  The decimator models keep the real and imaginary parts in separate arrays.
+ *
+ *  - sc16_deinterleave: SC16 -> re[], im[] (int32, sign extended), written directly into the stage buffers
+ *  - sc16_interleave:   re[], im[] (int32) -> SC16
+ *
+ *  Each 32-bit lane of a SIMD register holds one complex sample: the sign-extended I is obtained by
+ *  shifting the lane left and then arithmetically right by 16 bits, the sign-extended Q by an arithmetic shift
+ *  right by 16 bits. No shuffle tables are needed, 8 samples (AVX2) or 4 samples (SSE2) are converted per step.
+ *  A scalar loop converts the remaining samples (or all of them if the target has no SIMD extension).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef SC16_ADAPTER_H_
+#define SC16_ADAPTER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief deinterleave n SC16 samples into re[n], im[n]
+ */
+inline void sc16_deinterleave(const int16_t *iq, std::size_t n, int32_t *re, int32_t *im)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(iq + 2 * i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(re + i), _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(im + i), _mm256_srai_epi32(v, 16));
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(iq + 2 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(re + i), _mm_srai_epi32(_mm_slli_epi32(v, 16), 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(im + i), _mm_srai_epi32(v, 16));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        re[i] = iq[2 * i];
+        im[i] = iq[2 * i + 1];
+    }
+}
+
+/**
+ * @brief interleave re[n], im[n] (s16.15 values) into n SC16 samples
+ */
+inline void sc16_interleave(const int32_t *re, const int32_t *im, std::size_t n, int16_t *iq)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi32(0xFFFF);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i vre = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(re + i));
+        __m256i vim = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(im + i));
+        __m256i v = _mm256_or_si256(_mm256_and_si256(vre, mask), _mm256_slli_epi32(vim, 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(iq + 2 * i), v);
+    }
+#elif defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi32(0xFFFF);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i vre = _mm_loadu_si128(reinterpret_cast<const __m128i *>(re + i));
+        __m128i vim = _mm_loadu_si128(reinterpret_cast<const __m128i *>(im + i));
+        __m128i v = _mm_or_si128(_mm_and_si128(vre, mask), _mm_slli_epi32(vim, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(iq + 2 * i), v);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        iq[2 * i] = static_cast<int16_t>(re[i]);
+        iq[2 * i + 1] = static_cast<int16_t>(im[i]);
+    }
+}
+
+#endif /* SC16_ADAPTER_H_ */
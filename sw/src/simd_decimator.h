@@ -0,0 +1,501 @@
+/**
+ * @file simd_decimator.h
+ * @brief Channel-major SIMD software model of the multistage decimator.
+ *
+ * @details
+ *  Software engine for multi-channel offline processing (e.g. multi-antenna captures).
+ *  C independent channels are stored in struct-of-arrays form: each array holds one value per channel,
+ *  so every operation of the filter runs over the C channels in the innermost loop, and each SIMD lane
+ *  computes the full cascade of half-band stages for its own channel, with no horizontal reductions.
+ *
+ *  Input and output frames hold one complex sample per channel: re[n * C + c], im[n * C + c] (int16, s16.15),
+ *  or interleaved I/Q pairs (SC16) with process_sc16.
+ *
+ *  The engine is bit-exact with ssr_multistage_decimator (hw/src) built with the same compile-time options
+ *  (COEF_BITS, DATAOUT_BITS, DEC2_FS4_SHIFT, DEC4_FS4_SHIFT, same defaults, see ssr_multistage_decimator.h):
+ *  - each stage computes y(n) = sum_k h(k) x(n - k) with the 31-taps half-band prototype filter of hw/src/hbf_coefs.h,
+ *    and keeps the even output samples y(0), y(2), ... (the first input sample produces an output)
+ *  - the accumulator is exact (s<COEF_BITS>.<COEF_BITS - 1> x s16.15 products)
+ *  - the stage output is truncated to s16.15 with wrap-around (data_t: AP_TRN, AP_WRAP)
+ *  - the input sample n of the first (second) stage is multiplied by j^(DEC2_FS4_SHIFT n) (j^(DEC4_FS4_SHIFT n)),
+ *    with saturated negation (fs4_rotate in hw/src/dec_filters.h)
+ *  - the output samples are rounded (AP_RND_INF) and saturated (AP_SAT) to DATAOUT_BITS bits, and returned
+ *    in s16.15 format (same scale as the unpacked output bus, see packed_samples.h)
+ *  SSR_FFA and IQ_TDM change the architecture of the HLS design, not its output: the model covers them.
+ *
+ *  Only the non-zero taps are computed, exploiting the symmetry of the half-band filter:
+ *  y(n) = sum_{k = 0, 2, ..., 14} h(k) (x(n - k) + x(n - 30 + k)) + h(15) x(n - 15)
+ *
+ *  The stage kernel (hbf_stage_push, hbf_cascade_push, hbf_cascade_push_sc16) works on delay lines of any number
+ *  of channels: simd_decimator<C> runs it with a compile-time number of channels, arena_decimator with a run-time one.
+ *
+ * @note
+ *  The loops over the channels are written to be vectorized by the compiler (-O3 -march=native),
+ *  use C = 8 or 16 to fill the SIMD registers.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef SIMD_DECIMATOR_H_
+#define SIMD_DECIMATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sc16_adapter.h"
+
+// compile-time options of the HLS design (same macros and defaults as ssr_multistage_decimator.h)
+#ifndef COEF_BITS
+#define COEF_BITS 18
+#endif
+#ifndef DATAOUT_BITS
+#define DATAOUT_BITS 16
+#endif
+#ifndef DEC2_FS4_SHIFT
+#define DEC2_FS4_SHIFT 0
+#endif
+#ifndef DEC4_FS4_SHIFT
+#define DEC4_FS4_SHIFT 0
+#endif
+static_assert(COEF_BITS == 18 || COEF_BITS == 24 || COEF_BITS == 27, "COEF_BITS must be 18, 24 or 27");
+static_assert(DATAOUT_BITS == 16 || DATAOUT_BITS == 12 || DATAOUT_BITS == 8, "DATAOUT_BITS must be 16, 12 or 8");
+static_assert(DEC2_FS4_SHIFT >= -1 && DEC2_FS4_SHIFT <= 1, "DEC2_FS4_SHIFT must be 0, 1 or -1");
+static_assert(DEC4_FS4_SHIFT >= -1 && DEC4_FS4_SHIFT <= 1, "DEC4_FS4_SHIFT must be 0, 1 or -1");
+
+// prototype half-band filter of the HLS design (s<COEF_BITS>.<COEF_BITS - 1>)
+#include "../../hw/src/hbf_coefs.h"
+constexpr int hbf_num_coef = hbf_num_taps;
+constexpr int hbf_center = hbf_num_coef / 2;
+constexpr int hbf_coef_fractional_bits = COEF_BITS - 1;
+
+// fs/4 shift at the input of the stages (first and second stage, 0: no shift)
+constexpr int stage_fs4_shift[2] = {DEC2_FS4_SHIFT, DEC4_FS4_SHIFT};
+
+// maximum number of half-band stages (decimation factor 64)
+constexpr int max_num_stages = 6;
+
+/**
+ * @brief number of half-band stages for a decimation factor (1, 2, 4, ..., 64), -1 if not supported
+ */
+inline int num_stages_of(int dec_factor)
+{
+    for (int i = 0; i <= max_num_stages; ++i)
+    {
+        if (dec_factor == (1 << i))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief truncate the accumulator (32 fractional bits) to s16.15 with wrap-around
+ */
+inline int32_t quantize_acc(int64_t acc)
+{
+    return static_cast<int16_t>(static_cast<uint16_t>((acc >> hbf_coef_fractional_bits) & 0xFFFF));
+}
+
+/**
+ * @brief negate a s16.15 sample with saturation (-1.0 -> 1 - 2^-15, data_sat_t)
+ */
+inline int32_t negate_sat(int32_t x)
+{
+    return (x == INT16_MIN) ? INT16_MAX : -x;
+}
+
+/**
+ * @brief multiply a sample by j^phase (fs4_rotate in hw/src/dec_filters.h)
+ */
+inline void fs4_rotate(int phase, int32_t &re, int32_t &im)
+{
+    const int32_t x_re = re;
+    const int32_t x_im = im;
+    switch (phase & 3)
+    {
+    case 1:
+        re = negate_sat(x_im);
+        im = x_re;
+        break;
+    case 2:
+        re = negate_sat(x_re);
+        im = negate_sat(x_im);
+        break;
+    case 3:
+        re = x_im;
+        im = negate_sat(x_re);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief round (half away from zero, AP_RND_INF) and saturate (AP_SAT) a s16.15 output sample to DATAOUT_BITS bits,
+ *        returned in s16.15 format
+ */
+inline int32_t quantize_output(int32_t x)
+{
+    constexpr int shift = 16 - DATAOUT_BITS;
+    if (shift == 0)
+    {
+        return x;
+    }
+    constexpr int32_t half = 1 << (shift > 0 ? shift - 1 : 0);
+    constexpr int32_t max_q = (1 << (DATAOUT_BITS - 1)) - 1;
+    // |x| <= 2^15: only the positive full scale saturates
+    int32_t q = (x >= 0) ? (x + half) >> shift : -((-x + half) >> shift);
+    q = (q > max_q) ? max_q : q;
+    return q * (1 << shift);
+}
+
+/**
+ * @brief half-band decimator-by-2 stage, state of the stage kernel (hbf_stage_push)
+ *
+ * The delay line holds one value per channel and input frame, buf[i * channels + c], in storage owned by
+ * the decimator (simd_decimator, arena_decimator). It is a circular buffer stored twice (frames p and p + L),
+ * so the last L input frames are always contiguous: x(n - k) = buf[(p + k) * channels + c].
+ */
+struct hbf_stage
+{
+    int32_t *buf_re = nullptr;
+    int32_t *buf_im = nullptr;
+    int p = 0;
+    bool skip = false;
+    int fs4_shift = 0; // shift of the input by fs4_shift x fs/4 (0: no shift)
+    int fs4_phase = 0; // (fs4_shift x input sample index) mod 4
+};
+
+/**
+ * @brief clear the delay line and the decimation phase of a stage
+ */
+inline void hbf_stage_reset(hbf_stage &st, int channels)
+{
+    for (int i = 0; i < 2 * hbf_num_coef * channels; ++i)
+    {
+        st.buf_re[i] = 0;
+        st.buf_im[i] = 0;
+    }
+    st.p = 0;
+    st.skip = false;
+    st.fs4_phase = 0;
+}
+
+/**
+ * @brief shift the input frame just written to the slot p of the delay line by fs/4 (in place), and copy it to the
+ *        slot p + L
+ */
+inline void hbf_stage_commit(hbf_stage &st, int channels)
+{
+    const int C = channels;
+    const int L = hbf_num_coef;
+    int32_t *x_re_v = st.buf_re + st.p * C;
+    int32_t *x_im_v = st.buf_im + st.p * C;
+    for (int c = 0; c < C; ++c)
+    {
+        int32_t re = x_re_v[c];
+        int32_t im = x_im_v[c];
+        fs4_rotate(st.fs4_phase, re, im);
+        x_re_v[c] = re;
+        x_re_v[L * C + c] = re;
+        x_im_v[c] = im;
+        x_im_v[L * C + c] = im;
+    }
+    st.fs4_phase = (st.fs4_phase + st.fs4_shift) & 3;
+}
+
+/**
+ * @brief filter the delay line of a stage after an input frame
+ *
+ * acc_re, acc_im are scratch accumulators of one frame.
+ *
+ * @return true if the stage produced an output frame (written to y_re, y_im)
+ */
+inline bool hbf_stage_filter(hbf_stage &st, int channels, int32_t *y_re, int32_t *y_im, int64_t *acc_re, int64_t *acc_im)
+{
+    const int C = channels;
+    const int L = hbf_num_coef;
+
+    // decimation: every other input produces an output
+    bool valid = !st.skip;
+    st.skip = !st.skip;
+    if (!valid)
+    {
+        return false;
+    }
+
+    const int32_t *x_re_v = st.buf_re + st.p * C;
+    const int32_t *x_im_v = st.buf_im + st.p * C;
+    for (int c = 0; c < C; ++c)
+    {
+        acc_re[c] = static_cast<int64_t>(hbf_coef[hbf_center]) * x_re_v[hbf_center * C + c];
+        acc_im[c] = static_cast<int64_t>(hbf_coef[hbf_center]) * x_im_v[hbf_center * C + c];
+    }
+    // symmetric pairs of non-zero taps
+    for (int k = 0; k < hbf_center; k += 2)
+    {
+        const int64_t h = hbf_coef[k];
+        const int32_t *a_re = x_re_v + k * C;
+        const int32_t *b_re = x_re_v + (L - 1 - k) * C;
+        const int32_t *a_im = x_im_v + k * C;
+        const int32_t *b_im = x_im_v + (L - 1 - k) * C;
+        for (int c = 0; c < C; ++c)
+        {
+            acc_re[c] += h * (a_re[c] + b_re[c]);
+            acc_im[c] += h * (a_im[c] + b_im[c]);
+        }
+    }
+    for (int c = 0; c < C; ++c)
+    {
+        y_re[c] = quantize_acc(acc_re[c]);
+        y_im[c] = quantize_acc(acc_im[c]);
+    }
+    return true;
+}
+
+/**
+ * @brief push one input frame (x_re, x_im) into a stage
+ *
+ * y_re, y_im may alias x_re, x_im. acc_re, acc_im are scratch accumulators of one frame.
+ *
+ * @return true if the stage produced an output frame (written to y_re, y_im)
+ */
+inline bool hbf_stage_push(hbf_stage &st, int channels, const int32_t *x_re, const int32_t *x_im, int32_t *y_re, int32_t *y_im,
+                           int64_t *acc_re, int64_t *acc_im)
+{
+    const int C = channels;
+    st.p = (st.p == 0) ? hbf_num_coef - 1 : st.p - 1;
+    for (int c = 0; c < C; ++c)
+    {
+        st.buf_re[st.p * C + c] = x_re[c];
+        st.buf_im[st.p * C + c] = x_im[c];
+    }
+    hbf_stage_commit(st, C);
+    return hbf_stage_filter(st, C, y_re, y_im, acc_re, acc_im);
+}
+
+/**
+ * @brief push one input frame of interleaved SC16 samples into a stage: the frame is deinterleaved straight into
+ *        the delay line (see sc16_adapter.h)
+ * @return true if the stage produced an output frame (written to y_re, y_im)
+ */
+inline bool hbf_stage_push_sc16(hbf_stage &st, int channels, const int16_t *iq, int32_t *y_re, int32_t *y_im, int64_t *acc_re,
+                                int64_t *acc_im)
+{
+    const int C = channels;
+    st.p = (st.p == 0) ? hbf_num_coef - 1 : st.p - 1;
+    sc16_deinterleave(iq, C, st.buf_re + st.p * C, st.buf_im + st.p * C);
+    hbf_stage_commit(st, C);
+    return hbf_stage_filter(st, C, y_re, y_im, acc_re, acc_im);
+}
+
+/**
+ * @brief run the output frame of stage first - 1 (x_re, x_im) through the stages first .. num_stages - 1
+ * @return true if the last stage produced an output frame (written back to x_re, x_im, quantized to DATAOUT_BITS)
+ */
+inline bool hbf_cascade_tail(hbf_stage *stage, int first, int num_stages, int channels, int32_t *x_re, int32_t *x_im,
+                             int64_t *acc_re, int64_t *acc_im)
+{
+    bool valid = true;
+    for (int s = first; s < num_stages && valid; ++s)
+    {
+        valid = hbf_stage_push(stage[s], channels, x_re, x_im, x_re, x_im, acc_re, acc_im);
+    }
+    if (valid && DATAOUT_BITS != 16)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            x_re[c] = quantize_output(x_re[c]);
+            x_im[c] = quantize_output(x_im[c]);
+        }
+    }
+    return valid;
+}
+
+/**
+ * @brief run one input frame through a cascade of stages: each stage output is the input of the next stage
+ * @return true if the last stage produced an output frame (written back to x_re, x_im, quantized to DATAOUT_BITS)
+ */
+inline bool hbf_cascade_push(hbf_stage *stage, int num_stages, int channels, int32_t *x_re, int32_t *x_im, int64_t *acc_re,
+                             int64_t *acc_im)
+{
+    return hbf_cascade_tail(stage, 0, num_stages, channels, x_re, x_im, acc_re, acc_im);
+}
+
+/**
+ * @brief run one input frame of interleaved SC16 samples through a cascade of stages, deinterleaved straight into
+ *        the delay line of the first stage (into x_re, x_im without stages)
+ * @return true if the last stage produced an output frame (written to x_re, x_im, quantized to DATAOUT_BITS)
+ */
+inline bool hbf_cascade_push_sc16(hbf_stage *stage, int num_stages, int channels, const int16_t *iq, int32_t *x_re, int32_t *x_im,
+                                  int64_t *acc_re, int64_t *acc_im)
+{
+    if (num_stages == 0)
+    {
+        sc16_deinterleave(iq, channels, x_re, x_im);
+        return hbf_cascade_tail(stage, 0, 0, channels, x_re, x_im, acc_re, acc_im);
+    }
+    if (!hbf_stage_push_sc16(stage[0], channels, iq, x_re, x_im, acc_re, acc_im))
+    {
+        return false;
+    }
+    return hbf_cascade_tail(stage, 1, num_stages, channels, x_re, x_im, acc_re, acc_im);
+}
+
+/**
+ * @brief multistage decimator, C independent channels (one channel per SIMD lane)
+ *
+ * Fixed number of channels over the stage kernel: the loops over the channels have a compile-time trip count.
+ */
+template <int C>
+class simd_decimator
+{
+public:
+    static constexpr int num_channels = C;
+
+    simd_decimator()
+    {
+        for (int s = 0; s < max_num_stages; ++s)
+        {
+            stage[s].buf_re = &buf_re[s][0][0];
+            stage[s].buf_im = &buf_im[s][0][0];
+            stage[s].fs4_shift = (s < 2) ? stage_fs4_shift[s] : 0;
+        }
+        reset();
+    }
+
+    // the stages point to the delay lines of the object
+    simd_decimator(const simd_decimator &) = delete;
+    simd_decimator &operator=(const simd_decimator &) = delete;
+
+    /**
+     * @brief set the decimation factor (1, 2, 4, ..., 64) and reset the filters
+     * @return false if the decimation factor is not supported
+     */
+    bool configure(int dec_factor)
+    {
+        int n = num_stages_of(dec_factor);
+        if (n < 0)
+        {
+            return false;
+        }
+        num_stages = n;
+        reset();
+        return true;
+    }
+
+    int dec_factor() const
+    {
+        return 1 << num_stages;
+    }
+
+    /**
+     * @brief clear the state of the filters
+     */
+    void reset()
+    {
+        for (int s = 0; s < max_num_stages; ++s)
+        {
+            hbf_stage_reset(stage[s], C);
+        }
+    }
+
+    /**
+     * @brief reset the decimation phase, as the phase reset of the HLS design (phase_reset_i, see decimator_taps):
+     *        every stage keeps the next input frame, so it produces an output frame (the filter state is kept)
+     */
+    void phase_reset()
+    {
+        for (int s = 0; s < max_num_stages; ++s)
+        {
+            stage[s].skip = false;
+        }
+    }
+
+    /**
+     * @brief decimate num_frames input frames
+     *
+     * @param in_re, in_im    input frames, in_re[n * C + c]
+     * @param num_frames      number of input frames
+     * @param out_re, out_im  output frames, room for num_frames / dec_factor + 1 frames
+     * @return number of output frames
+     */
+    std::size_t process(const int16_t *in_re, const int16_t *in_im, std::size_t num_frames, int16_t *out_re, int16_t *out_im)
+    {
+        std::size_t num_out = 0;
+        alignas(64) int32_t x_re[C];
+        alignas(64) int32_t x_im[C];
+
+        for (std::size_t n = 0; n < num_frames; ++n)
+        {
+            for (int c = 0; c < C; ++c)
+            {
+                x_re[c] = in_re[n * C + c];
+                x_im[c] = in_im[n * C + c];
+            }
+
+            if (run_cascade(x_re, x_im))
+            {
+                for (int c = 0; c < C; ++c)
+                {
+                    out_re[num_out * C + c] = static_cast<int16_t>(x_re[c]);
+                    out_im[num_out * C + c] = static_cast<int16_t>(x_im[c]);
+                }
+                num_out++;
+            }
+        }
+        return num_out;
+    }
+
+    /**
+     * @brief decimate num_frames input frames of interleaved SC16 samples
+     *
+     * The frames are deinterleaved straight into the delay line of the first stage (no staging copy),
+     * the output frames are interleaved directly from the output of the last stage (see sc16_adapter.h).
+     *
+     * @param in_iq       input frames, I/Q of channel c of frame n at in_iq[2 * (n * C + c)], in_iq[2 * (n * C + c) + 1]
+     * @param num_frames  number of input frames
+     * @param out_iq      output frames, same layout, room for num_frames / dec_factor + 1 frames
+     * @return number of output frames
+     */
+    std::size_t process_sc16(const int16_t *in_iq, std::size_t num_frames, int16_t *out_iq)
+    {
+        std::size_t num_out = 0;
+        // output frame of the cascade
+        alignas(64) int32_t x_re[C];
+        alignas(64) int32_t x_im[C];
+
+        for (std::size_t n = 0; n < num_frames; ++n)
+        {
+            if (hbf_cascade_push_sc16(stage, num_stages, C, in_iq + 2 * n * C, x_re, x_im, acc_re, acc_im))
+            {
+                sc16_interleave(x_re, x_im, C, out_iq + 2 * num_out * C);
+                num_out++;
+            }
+        }
+        return num_out;
+    }
+
+private:
+    /**
+     * @brief run one input frame through the cascade (fixed number of channels, see hbf_cascade_push)
+     */
+    bool run_cascade(int32_t x_re[C], int32_t x_im[C])
+    {
+        return hbf_cascade_push(stage, num_stages, C, x_re, x_im, acc_re, acc_im);
+    }
+
+    static constexpr int L = hbf_num_coef;
+    alignas(64) int32_t buf_re[max_num_stages][2 * L][C] = {};
+    alignas(64) int32_t buf_im[max_num_stages][2 * L][C] = {};
+    alignas(64) int64_t acc_re[C];
+    alignas(64) int64_t acc_im[C];
+    hbf_stage stage[max_num_stages];
+    int num_stages = 0;
+};
+
+#endif /* SIMD_DECIMATOR_H_ */
@@ -0,0 +1,140 @@
+/**
+ * @file ssr_decimator_stream.cpp
+ * @brief Streaming interface to the C model of the ssr_multistage_decimator (hw/src).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#include "ssr_decimator_stream.h"
+
+ssr_decimator_stream::ssr_decimator_stream(int dec_factor)
+    : dec_factor(1), block_size(0), phase_reset_pending(false)
+{
+    configure(dec_factor);
+}
+
+bool ssr_decimator_stream::configure(int dec_factor)
+{
+    switch (dec_factor)
+    {
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+        this->dec_factor = dec_factor;
+        reset();
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ssr_decimator_stream::reset()
+{
+    // clear the delay lines of all the stages (the stages run whatever the decimation factor)
+    for (std::size_t i = 0; i < ssr; ++i)
+    {
+        block.re[i] = 0;
+        block.im[i] = 0;
+    }
+    phase_reset_pending = false;
+    for (int i = 0; i < reset_words; ++i)
+    {
+        clock(true);
+    }
+    for (int i = 0; i < flush_clocks; ++i)
+    {
+        clock(false);
+    }
+    output.clear();
+    block_size = 0;
+    phase_reset_pending = true;
+}
+
+void ssr_decimator_stream::push(const int16_t *iq, std::size_t num_samples)
+{
+    for (std::size_t n = 0; n < num_samples; ++n)
+    {
+        block.re[block_size].range() = iq[2 * n];
+        block.im[block_size].range() = iq[2 * n + 1];
+        if (++block_size == ssr)
+        {
+            clock(true);
+            block_size = 0;
+        }
+    }
+}
+
+void ssr_decimator_stream::flush(bool pad)
+{
+    if (pad && block_size > 0)
+    {
+        for (std::size_t i = block_size; i < ssr; ++i)
+        {
+            block.re[i] = 0;
+            block.im[i] = 0;
+        }
+        clock(true);
+        block_size = 0;
+    }
+    for (int i = 0; i < flush_clocks; ++i)
+    {
+        clock(false);
+    }
+}
+
+std::size_t ssr_decimator_stream::available() const
+{
+    return output.size() / 2;
+}
+
+std::size_t ssr_decimator_stream::read(int16_t *iq, std::size_t max_samples)
+{
+    std::size_t num_samples = (available() < max_samples) ? available() : max_samples;
+    for (std::size_t i = 0; i < 2 * num_samples; ++i)
+    {
+        iq[i] = output.front();
+        output.pop_front();
+    }
+    return num_samples;
+}
+
+std::size_t ssr_decimator_stream::remainder() const
+{
+    return block_size;
+}
+
+void ssr_decimator_stream::clock(bool tvalid)
+{
+    bool tvalid_o;
+    cdataout_vec_t<ssr> tdata_o;
+    sample_index_t sample_index_o;
+    // rising edge of the phase reset: applied by the C model to the next valid input word
+    bool phase_reset = phase_reset_pending;
+    phase_reset_pending = false;
+    ssr_multistage_decimator(dec_factor, tvalid, block, phase_reset, tvalid_o, tdata_o, sample_index_o);
+
+    if (tvalid_o)
+    {
+        for (std::size_t i = 0; i < samples_per_output(); ++i)
+        {
+            // output samples of dataout_bits bits, returned in s16.15 format (same scale as the 16-bit output)
+            ap_int<dataout_bits> out_re = tdata_o.re[i].range();
+            ap_int<dataout_bits> out_im = tdata_o.im[i].range();
+            output.push_back(static_cast<int16_t>(static_cast<int>(out_re) * (1 << (16 - dataout_bits))));
+            output.push_back(static_cast<int16_t>(static_cast<int>(out_im) * (1 << (16 - dataout_bits))));
+        }
+    }
+}
+
+std::size_t ssr_decimator_stream::samples_per_output() const
+{
+    // the first stages produce ssr / dec_factor samples per clock, the single-rate stages one sample
+    return (dec_factor < ssr) ? ssr / dec_factor : 1;
+}
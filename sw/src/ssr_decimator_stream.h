@@ -0,0 +1,105 @@
+/**
+ * @file ssr_decimator_stream.h
+ * @brief Streaming interface to the C model of the ssr_multistage_decimator (hw/src).
+ *
+ * @details
+ *  The C model consumes a block of ssr = 8 samples per call (one clock cycle).
+ *  ssr_decimator_stream accepts any number of samples per push: the samples are collected in
+ *  ssr-sample blocks, the remainder is kept until the next push. Each complete block is processed by
+ *  the C model and its valid output samples are queued, ready to be read with read().
+ *
+ *  The decimator output is delayed by the pipeline latency of the stages: flush() runs the C model
+ *  with no valid input until the outputs of all the complete blocks pushed so far are available.
+ *  The filter state and the decimation phase only change on valid inputs, so the output samples do not
+ *  depend on when (or how often) flush() is called.
+ *
+ *  configure() and reset() clear the state of the C model: zero input words clear the delay lines of all the stages,
+ *  the pipeline is drained (the outputs are discarded) and the next input word resets the decimation phase, so the
+ *  output is the same as the output of a new model.
+ *
+ *  Samples are interleaved 16-bit I/Q pairs (SC16, s16.15).
+ *
+ * @note
+ *  The C model keeps its state in static variables: use a single stream per process.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef SSR_DECIMATOR_STREAM_H_
+#define SSR_DECIMATOR_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "../../hw/src/ssr_multistage_decimator.h"
+
+class ssr_decimator_stream
+{
+public:
+    // number of clock cycles to flush the pipeline of the stages
+    static constexpr int flush_clocks = 160;
+    // number of zero input words to clear the delay lines of the stages
+    // (the impulse response of the 6 stages spans 31 x 63 input samples, 245 words)
+    static constexpr int reset_words = 512;
+
+    explicit ssr_decimator_stream(int dec_factor = 1);
+
+    /**
+     * @brief set the decimation factor (1, 2, 4, ..., 64) and reset the state
+     * @return false if the decimation factor is not supported (the state is not changed)
+     */
+    bool configure(int dec_factor);
+
+    /**
+     * @brief reset the state: clear the filters of the C model, the output queue and the remainder
+     */
+    void reset();
+
+    /**
+     * @brief push num_samples SC16 samples, any number of samples per call
+     */
+    void push(const int16_t *iq, std::size_t num_samples);
+
+    /**
+     * @brief run the pipeline until the outputs of all the complete blocks pushed so far are available
+     *
+     * @param pad  process the remainder (less than ssr samples) as a block padded with zeros
+     */
+    void flush(bool pad = false);
+
+    /**
+     * @brief number of output samples ready to be read
+     */
+    std::size_t available() const;
+
+    /**
+     * @brief read up to max_samples output samples (SC16)
+     * @return number of samples read
+     */
+    std::size_t read(int16_t *iq, std::size_t max_samples);
+
+    /**
+     * @brief number of input samples waiting for a complete block
+     */
+    std::size_t remainder() const;
+
+private:
+    // run the C model for one clock cycle, queue the valid output samples
+    void clock(bool tvalid);
+
+    // number of valid output samples per output block
+    std::size_t samples_per_output() const;
+
+    dec_factor_t dec_factor;
+    cdatain_vec_t<ssr> block;
+    std::size_t block_size;
+    std::deque<int16_t> output;
+    // the next input word resets the decimation phase
+    bool phase_reset_pending;
+};
+
+#endif /* SSR_DECIMATOR_STREAM_H_ */
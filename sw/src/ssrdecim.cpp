@@ -0,0 +1,116 @@
+/**
+ * @file ssrdecim.cpp
+ * @brief C interface of the multistage decimator library (libssrdecim.so).
+ *
+ * @details
+ *  The decimator is an arena_decimator with its arena allocated by ssrdecim_create,
+ *  sized for the largest decimation factor so that ssrdecim_configure never allocates.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#include <new>
+
+// export the functions (see SSRDECIM_API)
+#define SSRDECIM_BUILD
+#include "ssrdecim.h"
+#include "arena_decimator.h"
+
+struct ssrdecim
+{
+    arena_decimator decimator;
+    unsigned char *arena;
+    std::size_t arena_size;
+};
+
+int ssrdecim_abi_version(void)
+{
+    return SSRDECIM_ABI_VERSION;
+}
+
+int ssrdecim_option(int option, int *value)
+{
+    const int options[] = {COEF_BITS, DATAOUT_BITS, DEC2_FS4_SHIFT, DEC4_FS4_SHIFT}; // SSRDECIM_OPT_*
+    if (value == nullptr || option < 0 || option >= static_cast<int>(sizeof(options) / sizeof(options[0])))
+    {
+        return SSRDECIM_ERR_ARG;
+    }
+    *value = options[option];
+    return SSRDECIM_OK;
+}
+
+ssrdecim_t *ssrdecim_create(int num_channels)
+{
+    std::size_t arena_size = required_memory(1 << max_num_stages, num_channels);
+    if (arena_size == 0)
+    {
+        return nullptr;
+    }
+
+    ssrdecim_t *dec = new (std::nothrow) ssrdecim_t;
+    if (dec == nullptr)
+    {
+        return nullptr;
+    }
+    dec->arena = new (std::nothrow) unsigned char[arena_size];
+    dec->arena_size = arena_size;
+    if (dec->arena == nullptr || !dec->decimator.init(dec->arena, arena_size, 1, num_channels))
+    {
+        delete[] dec->arena;
+        delete dec;
+        return nullptr;
+    }
+    return dec;
+}
+
+int ssrdecim_configure(ssrdecim_t *dec, int dec_factor)
+{
+    if (dec == nullptr || num_stages_of(dec_factor) < 0)
+    {
+        return SSRDECIM_ERR_ARG;
+    }
+    dec->decimator.init(dec->arena, dec->arena_size, dec_factor, dec->decimator.channels());
+    return SSRDECIM_OK;
+}
+
+int ssrdecim_dec_factor(const ssrdecim_t *dec)
+{
+    return (dec == nullptr) ? SSRDECIM_ERR_ARG : dec->decimator.dec_factor();
+}
+
+size_t ssrdecim_process(ssrdecim_t *dec, const int16_t *in_iq, size_t num_frames, int16_t *out_iq)
+{
+    if (dec == nullptr || in_iq == nullptr || out_iq == nullptr)
+    {
+        return 0;
+    }
+    return dec->decimator.process_sc16(in_iq, num_frames, out_iq);
+}
+
+void ssrdecim_reset(ssrdecim_t *dec)
+{
+    if (dec != nullptr)
+    {
+        dec->decimator.reset();
+    }
+}
+
+void ssrdecim_phase_reset(ssrdecim_t *dec)
+{
+    if (dec != nullptr)
+    {
+        dec->decimator.phase_reset();
+    }
+}
+
+void ssrdecim_destroy(ssrdecim_t *dec)
+{
+    if (dec != nullptr)
+    {
+        delete[] dec->arena;
+        delete dec;
+    }
+}
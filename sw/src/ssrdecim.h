@@ -0,0 +1,131 @@
+/**
+ * @file ssrdecim.h
+ * @brief C interface of the multistage decimator library (libssrdecim.so).
+ *
+ * @details
+ *  Plain C interface for C and C++ host applications: the library runs the same algorithm as the FPGA
+ *  (bit-exact with ssr_multistage_decimator, hw/src, built with the same compile-time options, see simd_decimator.h),
+ *  so the decimation can be moved to the host whenever the FPGA path is busy.
+ *
+ *  Each decimator holds any number of independent channels. The samples are interleaved 16-bit I/Q pairs
+ *  (SC16, s16.15), one frame holds one sample per channel: channel c of frame n at iq[2 * (n * channels + c)].
+ *
+ *  All the memory is allocated by ssrdecim_create: configure, process, reset and phase_reset never allocate.
+ *
+ *  ABI: the decimator is an opaque handle, the functions only take scalar types and pointers to integers.
+ *  SSRDECIM_ABI_VERSION changes when the interface changes in an incompatible way
+ *  (ssrdecim_abi_version returns the version of the library at run time).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef SSRDECIM_H_
+#define SSRDECIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// SSRDECIM_BUILD is defined while the library itself is built (ssrdecim.cpp)
+#if defined(_WIN32) && defined(SSRDECIM_BUILD)
+#define SSRDECIM_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define SSRDECIM_API __declspec(dllimport)
+#else
+#define SSRDECIM_API __attribute__((visibility("default")))
+#endif
+
+#define SSRDECIM_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // return codes
+    enum
+    {
+        SSRDECIM_OK = 0,
+        SSRDECIM_ERR_ARG = -1, // invalid argument (null handle, unsupported decimation factor)
+    };
+
+    // compile-time options of the library (see ssrdecim_option)
+    enum
+    {
+        SSRDECIM_OPT_COEF_BITS = 0,      // width of the filter coefficients (18, 24, 27)
+        SSRDECIM_OPT_DATAOUT_BITS = 1,   // width of the output samples (16, 12, 8), returned in s16.15
+        SSRDECIM_OPT_DEC2_FS4_SHIFT = 2, // fs/4 shift at the input of the first stage (0, 1, -1)
+        SSRDECIM_OPT_DEC4_FS4_SHIFT = 3, // fs/4 shift at the input of the second stage (0, 1, -1)
+    };
+
+    typedef struct ssrdecim ssrdecim_t;
+
+    /**
+     * @brief ABI version of the library (SSRDECIM_ABI_VERSION it was built with)
+     */
+    SSRDECIM_API int ssrdecim_abi_version(void);
+
+    /**
+     * @brief compile-time option the library was built with (SSRDECIM_OPT_*)
+     *
+     * The options change the output but not the interface: libraries built with different options share the soname,
+     * the host checks the options it expects at run time.
+     *
+     * @param option  SSRDECIM_OPT_*
+     * @param value   value of the option
+     * @return SSRDECIM_OK, SSRDECIM_ERR_ARG if the option is not known or value is NULL
+     */
+    SSRDECIM_API int ssrdecim_option(int option, int *value);
+
+    /**
+     * @brief create a decimator with num_channels channels, decimation factor 1
+     * @return the decimator, NULL if num_channels is not valid or the allocation failed
+     */
+    SSRDECIM_API ssrdecim_t *ssrdecim_create(int num_channels);
+
+    /**
+     * @brief set the decimation factor (1, 2, 4, ..., 64) and reset the filters
+     * @return SSRDECIM_OK, SSRDECIM_ERR_ARG if the decimation factor is not supported (the configuration is unchanged)
+     */
+    SSRDECIM_API int ssrdecim_configure(ssrdecim_t *dec, int dec_factor);
+
+    /**
+     * @brief decimation factor of the decimator, SSRDECIM_ERR_ARG if dec is NULL
+     */
+    SSRDECIM_API int ssrdecim_dec_factor(const ssrdecim_t *dec);
+
+    /**
+     * @brief decimate a block of num_frames input frames
+     *
+     * The filter state is kept between calls: a signal can be processed in blocks of any size.
+     *
+     * @param in_iq       input frames (SC16)
+     * @param num_frames  number of input frames
+     * @param out_iq      output frames (SC16), room for num_frames / dec_factor + 1 frames
+     * @return number of output frames
+     */
+    SSRDECIM_API size_t ssrdecim_process(ssrdecim_t *dec, const int16_t *in_iq, size_t num_frames, int16_t *out_iq);
+
+    /**
+     * @brief clear the state of the filters
+     */
+    SSRDECIM_API void ssrdecim_reset(ssrdecim_t *dec);
+
+    /**
+     * @brief reset the decimation phase (e.g. on a SYSREF), as the phase reset of the FPGA design:
+     *        the next input frame produces an output frame, the filter state is kept
+     */
+    SSRDECIM_API void ssrdecim_phase_reset(ssrdecim_t *dec);
+
+    /**
+     * @brief destroy the decimator (NULL is ignored)
+     */
+    SSRDECIM_API void ssrdecim_destroy(ssrdecim_t *dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SSRDECIM_H_ */
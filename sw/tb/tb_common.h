@@ -0,0 +1,209 @@
+/**
+ * @file tb_common.h
+ * @brief Common part of the testbenches of the software models (C and C++).
+ *
+ * @details
+ *  - readParameterFile, readSamples: test case files of the HLS testbench (work/parameters.csv, *.txt)
+ *  - goldenCheck: decimates the reference stimulus (<golden>/input_test_vector.txt) for a list of decimation factors
+ *    and compares the output with the C-simulation of the HLS design (<golden>/output_dec<d>.txt,
+ *    see scripts/golden_vectors.py)
+ *  - runTestCase: decimates the test case of the work folder, if any, and writes the output, one complex sample
+ *    per line, to be compared with the valid samples of the C-simulation
+ *  - testResult: PASS / FAIL and exit code
+ *
+ *  Each testbench only provides its model as a tb_decimate_t function. The samples are interleaved I/Q pairs
+ *  (SC16), the buffers returned by readSamples and tb_decimate_t are allocated with malloc.
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#ifndef TB_COMMON_H_
+#define TB_COMMON_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ANSI escape codes for setting text colors
+#define TB_GREEN "\033[32m"
+#define TB_RED "\033[31m"
+#define TB_RESET "\033[0m"
+
+/**
+ * @brief decimate a signal with the model of the testbench
+ *
+ * @param model       model of the testbench (context passed to goldenCheck and runTestCase)
+ * @param dec_factor  decimation factor
+ * @param in_iq       input signal, num_samples complex samples
+ * @param num_out     number of complex output samples
+ * @param errors      the mismatches found by the model-specific checks are added to *errors
+ * @return the output signal (malloc), NULL if the decimation factor is not supported
+ */
+typedef int16_t *(*tb_decimate_t)(void *model, int dec_factor, const int16_t *in_iq, size_t num_samples, size_t *num_out, int *errors);
+
+/**
+ * @brief decimation factor of a parameter file (last value, comments start with #)
+ */
+static inline int readParameterFile(FILE *parameterFile)
+{
+    int dec_factor = 1;
+    char line[256];
+    while (fgets(line, sizeof(line), parameterFile))
+    {
+        // Skip empty lines and comments
+        if (line[0] == '\n' || line[0] == '#')
+            continue;
+        dec_factor = atoi(line);
+    }
+    return dec_factor;
+}
+
+/**
+ * @brief read the complex samples of a file ("re im" pairs, any number per line), *num_samples samples
+ * @return the samples (malloc), NULL if the file cannot be opened
+ */
+static inline int16_t *readSamples(const char *fileName, size_t *num_samples)
+{
+    FILE *file = fopen(fileName, "r");
+    if (!file)
+    {
+        return NULL;
+    }
+    size_t capacity = 1024;
+    int16_t *iq = (int16_t *)malloc(2 * capacity * sizeof(int16_t));
+    int re, im;
+    *num_samples = 0;
+    while (fscanf(file, "%d %d", &re, &im) == 2)
+    {
+        if (*num_samples == capacity)
+        {
+            capacity *= 2;
+            iq = (int16_t *)realloc(iq, 2 * capacity * sizeof(int16_t));
+        }
+        iq[2 * *num_samples] = (int16_t)re;
+        iq[2 * *num_samples + 1] = (int16_t)im;
+        (*num_samples)++;
+    }
+    fclose(file);
+    return iq;
+}
+
+/**
+ * @brief golden check: decimate the reference stimulus of the folder golden for each decimation factor
+ *        and compare the output sample by sample with the reference vectors
+ * @return the number of mismatches, -1 if the reference files cannot be read
+ */
+static inline int goldenCheck(const char *golden, const int *dec_factors, int num_factors, tb_decimate_t decimate, void *model)
+{
+    char fileName[512];
+    size_t num_samples;
+    snprintf(fileName, sizeof(fileName), "%s/input_test_vector.txt", golden);
+    int16_t *golden_in = readSamples(fileName, &num_samples);
+    if (!golden_in)
+    {
+        fprintf(stderr, "Error: could not open the reference files (run the testbench from the data folder).\n");
+        return -1;
+    }
+
+    int errors = 0;
+    for (int i = 0; i < num_factors; ++i)
+    {
+        int dec_factor = dec_factors[i];
+        size_t num_golden, num_out;
+        snprintf(fileName, sizeof(fileName), "%s/output_dec%d.txt", golden, dec_factor);
+        int16_t *golden_out = readSamples(fileName, &num_golden);
+        if (!golden_out)
+        {
+            fprintf(stderr, "Error: could not open the reference output of decimation factor %d\n", dec_factor);
+            errors = -1;
+            break;
+        }
+        int mismatches = 0;
+        int16_t *out = decimate(model, dec_factor, golden_in, num_samples, &num_out, &mismatches);
+        mismatches += (out == NULL || num_out != num_golden);
+        for (size_t n = 0; out != NULL && n < num_out && n < num_golden; ++n)
+        {
+            mismatches += (out[2 * n] != golden_out[2 * n] || out[2 * n + 1] != golden_out[2 * n + 1]);
+        }
+        printf("%sGolden dec %d: %zu samples, %d mismatches" TB_RESET "\n", mismatches ? TB_RED : TB_GREEN, dec_factor,
+               out ? num_out : 0, mismatches);
+        errors += mismatches;
+        free(out);
+        free(golden_out);
+    }
+    free(golden_in);
+    return errors;
+}
+
+/**
+ * @brief test case of the work folder (work/parameters.csv, work/input_test_vector.txt), if any:
+ *        decimate the input and write the output to outputName, one complex sample per line
+ *
+ * @param dec_factor   decimation factor of the test case, 0 if there is no test case
+ * @param num_samples  number of complex input samples
+ * @param num_out      number of complex output samples
+ * @return the number of mismatches of the model-specific checks, -1 if the test case cannot be run
+ */
+static inline int runTestCase(const char *outputName, tb_decimate_t decimate, void *model, int *dec_factor, size_t *num_samples,
+                              size_t *num_out)
+{
+    *dec_factor = 0;
+    FILE *parameterFile = fopen("work/parameters.csv", "r");
+    if (!parameterFile)
+    {
+        return 0;
+    }
+    *dec_factor = readParameterFile(parameterFile);
+    fclose(parameterFile);
+
+    int16_t *in = readSamples("work/input_test_vector.txt", num_samples);
+    FILE *outputFile = fopen(outputName, "w");
+    if (!in || !outputFile)
+    {
+        fprintf(stderr, "Error: could not open the test case files.\n");
+        free(in);
+        if (outputFile)
+            fclose(outputFile);
+        return -1;
+    }
+    int errors = 0;
+    int16_t *out = decimate(model, *dec_factor, in, *num_samples, num_out, &errors);
+    if (!out)
+    {
+        fprintf(stderr, "Error: invalid decimation factor %d\n", *dec_factor);
+        errors = -1;
+    }
+    for (size_t n = 0; out != NULL && n < *num_out; ++n)
+    {
+        fprintf(outputFile, "%d %d\n", out[2 * n], out[2 * n + 1]);
+    }
+    fclose(outputFile);
+    free(in);
+    free(out);
+
+    if (errors >= 0)
+    {
+        printf("Decimation factor: %d\n", *dec_factor);
+    }
+    return errors;
+}
+
+/**
+ * @brief print the result of the testbench
+ * @return the exit code of the testbench
+ */
+static inline int testResult(int errors)
+{
+    if (errors)
+    {
+        printf(TB_RED "FAIL: %d mismatches" TB_RESET "\n", errors);
+        return 1;
+    }
+    printf(TB_GREEN "PASS" TB_RESET "\n");
+    return 0;
+}
+
+#endif /* TB_COMMON_H_ */
@@ -0,0 +1,226 @@
+/**
+ * @file tb_simd_decimator.cpp
+ * @brief Testbench for the channel-major SIMD software model of the multistage decimator.
+ *
+ * Golden check: for every decimation factor, decimates the reference stimulus (<golden>/input_test_vector.txt) and
+ * compares the output with the C-simulation of the HLS design (<golden>/output_dec<d>.txt, see scripts/golden_vectors.py).
+ * The golden folder is the first argument (default: golden, the reference vectors of the default build): the testbench
+ * must be built with the same compile-time options as the C-simulation that produced the reference vectors.
+ *
+ * Test case: reads the same test case files as the HLS testbench (work/parameters.csv, work/input_test_vector.txt)
+ * when they are present, and writes the output of channel 0 to work/output_sw.txt, one complex sample per line,
+ * to be compared with the valid samples of the C-simulation.
+ *
+ * In both cases the input signal is decimated on all the channels of simd_decimator (the I/Q components are swapped
+ * on the odd channels, without fs/4 shifts), and the testbench checks that every channel produces the same output, and that the split
+ * re/im and the interleaved SC16 interfaces, and arena_decimator (working in a caller-provided arena), give the same result.
+ * It also checks that arena_decimator follows simd_decimator through a mid-stream phase reset
+ * (golden check and test case: see tb_common.h).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "../src/simd_decimator.h"
+#include "../src/arena_decimator.h"
+#include "tb_common.h"
+
+// number of channels (SIMD lanes)
+constexpr int num_channels = 8;
+
+// Function prototype.
+int decimate(int dec_factor, const std::vector<int16_t> &re, const std::vector<int16_t> &im, std::vector<int16_t> &out_re,
+             std::vector<int16_t> &out_im, double &seconds);
+int16_t *decimateSc16(void *model, int dec_factor, const int16_t *in_iq, std::size_t num_samples, std::size_t *num_out, int *errors);
+
+int main(int argc, char **argv)
+{
+    std::cout << TB_GREEN << "-----------------------------------------" << TB_RESET << std::endl;
+    std::cout << TB_GREEN << "- SIMD Multistage Decimator Testbench   -" << TB_RESET << std::endl;
+    std::cout << TB_GREEN << "-----------------------------------------" << TB_RESET << std::endl;
+
+    int errors = 0;
+    // processing time of the split re/im interface (last call of decimate)
+    double seconds = 0;
+
+    // -----------------------------------------------------
+    // Golden check: every decimation factor
+    // -----------------------------------------------------
+    const int dec_factors[] = {1, 2, 4, 8, 16, 32, 64};
+    int golden_errors = goldenCheck((argc > 1) ? argv[1] : "golden", dec_factors, sizeof(dec_factors) / sizeof(dec_factors[0]), decimateSc16, &seconds);
+    if (golden_errors < 0)
+    {
+        return 1;
+    }
+    errors += golden_errors;
+
+    // -----------------------------------------------------
+    // Test case of the work folder (if any)
+    // -----------------------------------------------------
+    int dec_factor;
+    std::size_t num_samples, num_out;
+    int test_errors = runTestCase("work/output_sw.txt", decimateSc16, &seconds, &dec_factor, &num_samples, &num_out);
+    if (test_errors < 0)
+    {
+        return 1;
+    }
+    errors += test_errors;
+    if (dec_factor)
+    {
+        std::cout << "numSamplesInput: " << num_samples << ", numSamplesOutput: " << num_out << " per channel" << std::endl;
+        std::cout << "Throughput: " << (seconds > 0 ? num_samples * num_channels / seconds / 1e6 : 0) << " MSPS (all channels)" << std::endl;
+    }
+
+    return testResult(errors);
+}
+
+/**
+ * @brief decimate SC16 samples with decimate (tb_decimate_t), the processing time in *model (double)
+ */
+int16_t *decimateSc16(void *model, int dec_factor, const int16_t *in_iq, std::size_t num_samples, std::size_t *num_out, int *errors)
+{
+    if (num_stages_of(dec_factor) < 0)
+    {
+        return nullptr;
+    }
+    std::vector<int16_t> re(num_samples);
+    std::vector<int16_t> im(num_samples);
+    for (std::size_t n = 0; n < num_samples; ++n)
+    {
+        re[n] = in_iq[2 * n];
+        im[n] = in_iq[2 * n + 1];
+    }
+    std::vector<int16_t> out_re;
+    std::vector<int16_t> out_im;
+    *errors += decimate(dec_factor, re, im, out_re, out_im, *static_cast<double *>(model));
+
+    *num_out = out_re.size();
+    int16_t *out_iq = static_cast<int16_t *>(std::malloc(2 * (*num_out + 1) * sizeof(int16_t)));
+    for (std::size_t n = 0; n < *num_out; ++n)
+    {
+        out_iq[2 * n] = out_re[n];
+        out_iq[2 * n + 1] = out_im[n];
+    }
+    return out_iq;
+}
+
+/**
+ * @brief decimate a signal on all the channels and with all the interfaces of the model
+ *
+ * Returns the number of mismatches between the channels and the interfaces, the output of channel 0 (out_re, out_im)
+ * and the processing time of the split re/im interface.
+ */
+int decimate(int dec_factor, const std::vector<int16_t> &re, const std::vector<int16_t> &im, std::vector<int16_t> &out_re_ch0,
+             std::vector<int16_t> &out_im_ch0, double &seconds)
+{
+    static simd_decimator<num_channels> decimator;
+    decimator.configure(dec_factor);
+
+    // distribute the input signal to all the channels (I/Q swapped on the odd channels, except with the fs/4 shifts:
+    // the rotation of the swapped signal is not the swapped rotation)
+    const bool swap_iq = (DEC2_FS4_SHIFT == 0 && DEC4_FS4_SHIFT == 0);
+    std::size_t num_frames = re.size();
+    std::vector<int16_t> in_re(num_frames * num_channels);
+    std::vector<int16_t> in_im(num_frames * num_channels);
+    for (std::size_t n = 0; n < num_frames; ++n)
+    {
+        for (int c = 0; c < num_channels; ++c)
+        {
+            in_re[n * num_channels + c] = (swap_iq && (c & 1)) ? im[n] : re[n];
+            in_im[n * num_channels + c] = (swap_iq && (c & 1)) ? re[n] : im[n];
+        }
+    }
+
+    std::vector<int16_t> out_re(num_frames / dec_factor * num_channels + num_channels);
+    std::vector<int16_t> out_im(num_frames / dec_factor * num_channels + num_channels);
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t num_out = decimator.process(in_re.data(), in_im.data(), num_frames, out_re.data(), out_im.data());
+    auto stop = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(stop - start).count();
+
+    // same processing with interleaved SC16 input and output
+    std::vector<int16_t> in_iq(2 * num_frames * num_channels);
+    std::vector<int16_t> out_iq(2 * out_re.size());
+    for (std::size_t i = 0; i < num_frames * num_channels; ++i)
+    {
+        in_iq[2 * i] = in_re[i];
+        in_iq[2 * i + 1] = in_im[i];
+    }
+    decimator.reset();
+    std::size_t num_out_sc16 = decimator.process_sc16(in_iq.data(), num_frames, out_iq.data());
+
+    // same processing with the working memory in a caller-provided arena
+    std::vector<unsigned char> arena(required_memory(dec_factor, num_channels));
+    std::vector<int16_t> out_arena(out_iq.size());
+    arena_decimator decimator_arena;
+    std::size_t num_out_arena = 0;
+    if (decimator_arena.init(arena.data(), arena.size(), dec_factor, num_channels))
+    {
+        num_out_arena = decimator_arena.process_sc16(in_iq.data(), num_frames, out_arena.data());
+    }
+
+    // mid-stream phase reset at an odd input frame (both models keep the frame of the phase reset)
+    std::size_t reset_frame = (num_frames / 3) | 1;
+    std::vector<int16_t> out_reset(out_iq.size() + 2 * num_channels);
+    std::vector<int16_t> out_reset_arena(out_reset.size());
+    decimator.reset();
+    std::size_t num_out_reset = decimator.process_sc16(in_iq.data(), reset_frame, out_reset.data());
+    decimator.phase_reset();
+    num_out_reset += decimator.process_sc16(in_iq.data() + 2 * reset_frame * num_channels, num_frames - reset_frame,
+                                            out_reset.data() + 2 * num_out_reset * num_channels);
+    std::size_t num_out_reset_arena = 0;
+    if (decimator_arena.init(arena.data(), arena.size(), dec_factor, num_channels))
+    {
+        num_out_reset_arena = decimator_arena.process_sc16(in_iq.data(), reset_frame, out_reset_arena.data());
+        decimator_arena.phase_reset();
+        num_out_reset_arena += decimator_arena.process_sc16(in_iq.data() + 2 * reset_frame * num_channels, num_frames - reset_frame,
+                                                            out_reset_arena.data() + 2 * num_out_reset_arena * num_channels);
+    }
+
+    // check that all the channels produce the same output
+    int errors = 0;
+    if (num_out_sc16 != num_out || num_out_arena != num_out || num_out_reset_arena != num_out_reset)
+    {
+        errors++;
+    }
+    for (std::size_t i = 0; i < 2 * num_out_reset * num_channels; ++i)
+    {
+        errors += (out_reset_arena[i] != out_reset[i]);
+    }
+    for (std::size_t i = 0; i < num_out * num_channels; ++i)
+    {
+        if (out_iq[2 * i] != out_re[i] || out_iq[2 * i + 1] != out_im[i])
+        {
+            errors++;
+        }
+        if (out_arena[2 * i] != out_iq[2 * i] || out_arena[2 * i + 1] != out_iq[2 * i + 1])
+        {
+            errors++;
+        }
+    }
+    out_re_ch0.resize(num_out);
+    out_im_ch0.resize(num_out);
+    for (std::size_t n = 0; n < num_out; ++n)
+    {
+        out_re_ch0[n] = out_re[n * num_channels];
+        out_im_ch0[n] = out_im[n * num_channels];
+        for (int c = 1; c < num_channels; ++c)
+        {
+            int16_t re_c = (swap_iq && (c & 1)) ? out_im[n * num_channels + c] : out_re[n * num_channels + c];
+            int16_t im_c = (swap_iq && (c & 1)) ? out_re[n * num_channels + c] : out_im[n * num_channels + c];
+            if (re_c != out_re_ch0[n] || im_c != out_im_ch0[n])
+            {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file tb_ssr_decimator_stream.cpp
+ * @brief Testbench for the streaming interface to the C model of the ssr multistage decimator.
+ *
+ * The input is read as a plain sequence of samples (any number of samples per line) and pushed to
+ * ssr_decimator_stream in chunks of varying size (1 to max_chunk_size samples), flushing the pipeline from time to time.
+ *
+ * Golden check: for every decimation factor, the same stream is reconfigured and decimates the reference stimulus
+ * (<golden>/input_test_vector.txt), the output is compared with the C-simulation (<golden>/output_dec<d>.txt).
+ * The golden folder is the first argument (default: golden, the reference vectors of the default build).
+ *
+ * Test case: reads the same test case files as the HLS testbench (work/parameters.csv, work/input_test_vector.txt)
+ * when they are present, and writes the output to work/output_stream.txt, one complex sample per line
+ * (golden check and test case: see tb_common.h).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../src/ssr_decimator_stream.h"
+#include "tb_common.h"
+
+// maximum number of samples per push
+constexpr std::size_t max_chunk_size = 37;
+// flush the pipeline every flush_period pushes
+constexpr int flush_period = 16;
+
+// model of the testbench: the same stream is reconfigured for every signal
+struct streamModel_t
+{
+    ssr_decimator_stream decimator;
+    std::size_t num_left = 0; // input samples left in the remainder by the last signal
+};
+
+// Function prototype.
+std::size_t runStream(ssr_decimator_stream &decimator, const std::vector<int16_t> &in_iq, std::vector<int16_t> &out_iq);
+int16_t *decimateStream(void *model, int dec_factor, const int16_t *in_iq, std::size_t num_samples, std::size_t *num_out, int *errors);
+
+int main(int argc, char **argv)
+{
+    std::cout << TB_GREEN << "-----------------------------------------" << TB_RESET << std::endl;
+    std::cout << TB_GREEN << "- Streaming Multistage Decimator Tb     -" << TB_RESET << std::endl;
+    std::cout << TB_GREEN << "-----------------------------------------" << TB_RESET << std::endl;
+
+    streamModel_t model;
+    int errors = 0;
+
+    // -----------------------------------------------------
+    // Golden check: every decimation factor, the same stream reconfigured between the factors
+    // -----------------------------------------------------
+    const int golden_factors[] = {64, 1, 8, 2, 32, 4, 16};
+    int golden_errors = goldenCheck((argc > 1) ? argv[1] : "golden", golden_factors, sizeof(golden_factors) / sizeof(golden_factors[0]),
+                                    decimateStream, &model);
+    if (golden_errors < 0)
+    {
+        return 1;
+    }
+    errors += golden_errors;
+
+    // -----------------------------------------------------
+    // Test case of the work folder (if any)
+    // -----------------------------------------------------
+    int dec_factor;
+    std::size_t num_samples, num_out;
+    int test_errors = runTestCase("work/output_stream.txt", decimateStream, &model, &dec_factor, &num_samples, &num_out);
+    if (test_errors < 0)
+    {
+        return 1;
+    }
+    errors += test_errors;
+    if (dec_factor)
+    {
+        std::cout << "numSamplesInput: " << num_samples << " (" << model.num_left << " left in the remainder)"
+                  << ", numSamplesOutput: " << num_out << std::endl;
+
+        // every complete block of ssr samples must produce its output samples
+        std::size_t num_expected = (num_samples - model.num_left) / dec_factor;
+        if (num_out != num_expected)
+        {
+            std::cout << TB_RED << "Test case: expected " << num_expected << " output samples" << TB_RESET << std::endl;
+            errors++;
+        }
+    }
+
+    return testResult(errors);
+}
+
+/**
+ * @brief configure the stream and push a signal through it (tb_decimate_t)
+ */
+int16_t *decimateStream(void *model, int dec_factor, const int16_t *in_iq, std::size_t num_samples, std::size_t *num_out, int *errors)
+{
+    streamModel_t &stream = *static_cast<streamModel_t *>(model);
+    if (!stream.decimator.configure(dec_factor))
+    {
+        return nullptr;
+    }
+    std::vector<int16_t> in(in_iq, in_iq + 2 * num_samples);
+    std::vector<int16_t> out;
+    stream.num_left = runStream(stream.decimator, in, out);
+
+    *num_out = out.size() / 2;
+    int16_t *out_iq = static_cast<int16_t *>(std::malloc((out.size() + 2) * sizeof(int16_t)));
+    std::copy(out.begin(), out.end(), out_iq);
+    return out_iq;
+}
+
+/**
+ * @brief push the input to the stream in chunks of varying size, flushing the pipeline from time to time
+ *
+ * Returns the number of input samples left in the remainder, the output samples are appended to out_iq.
+ */
+std::size_t runStream(ssr_decimator_stream &decimator, const std::vector<int16_t> &in_iq, std::vector<int16_t> &out_iq)
+{
+    std::size_t num_samples = in_iq.size() / 2;
+    std::vector<int16_t> chunk_out(2 * max_chunk_size);
+    std::size_t n = 0;
+    for (int push = 0; n < num_samples; ++push)
+    {
+        std::size_t chunk_size = 1 + (push * 7 + push / 5) % max_chunk_size;
+        if (chunk_size > num_samples - n)
+        {
+            chunk_size = num_samples - n;
+        }
+        decimator.push(&in_iq[2 * n], chunk_size);
+        n += chunk_size;
+
+        if (push % flush_period == flush_period - 1)
+        {
+            decimator.flush();
+        }
+        // read the output in small chunks
+        std::size_t num_read;
+        while ((num_read = decimator.read(chunk_out.data(), max_chunk_size)) > 0)
+        {
+            out_iq.insert(out_iq.end(), chunk_out.begin(), chunk_out.begin() + 2 * num_read);
+        }
+    }
+    decimator.flush();
+    while (decimator.available() > 0)
+    {
+        std::size_t num_read = decimator.read(chunk_out.data(), max_chunk_size);
+        out_iq.insert(out_iq.end(), chunk_out.begin(), chunk_out.begin() + 2 * num_read);
+    }
+    return decimator.remainder();
+}
@@ -0,0 +1,164 @@
+/**
+ * @file tb_ssrdecim.c
+ * @brief Testbench (C) for the C interface of the multistage decimator library (libssrdecim.so).
+ *
+ * Golden check: for every decimation factor, decimates the reference stimulus (<golden>/input_test_vector.txt) and
+ * compares the output with the C-simulation of the HLS design (<golden>/output_dec<d>.txt, see scripts/golden_vectors.py).
+ * The golden folder is the first argument (default: golden, the reference vectors of the default build): the library
+ * must be built with the same compile-time options as the C-simulation that produced the reference vectors.
+ *
+ * Test case: reads the same test case files as the HLS testbench (work/parameters.csv, work/input_test_vector.txt)
+ * when they are present, and writes channel 0 to work/output_lib.txt, one complex sample per line,
+ * to be compared with the valid samples of the C-simulation.
+ *
+ * In both cases the input signal is decimated on num_channels channels of the library in blocks of varying size.
+ * Each channel gets a distinct variant of the signal (delayed by a multiple of 64 frames, I/Q swapped on the odd
+ * channels without fs/4 shifts), and the testbench checks that every channel produces the output of channel 0 once
+ * the variant is undone (golden check and test case: see tb_common.h).
+ *
+ * @author marco.pausini@gmail.com
+ * @date 2023-11-xy
+ * @version 0.1
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/ssrdecim.h"
+#include "tb_common.h"
+
+// number of channels (not a power of two, on purpose)
+#define num_channels 3
+// maximum number of input frames per block
+#define max_block_size 100
+// delay between the channels (input frames): a multiple of the largest decimation factor and of the period of
+// the fs/4 shifts, so the delayed channels keep the decimation and fs/4 phases of channel 0
+#define channel_delay 64
+
+// decimate the signal in_iq (num_frames samples) on all the channels in blocks of varying size (tb_decimate_t),
+// returns the output of channel 0 (*num_out samples) and adds the mismatches between the channels to *errors
+// (model: int, swap I/Q on the odd channels)
+static int16_t *decimate(void *model, int dec_factor, const int16_t *in_iq, size_t num_frames, size_t *num_out, int *errors)
+{
+    const int swap_iq = *(const int *)model;
+    ssrdecim_t *dec = ssrdecim_create(num_channels);
+    if (dec == NULL || ssrdecim_configure(dec, dec_factor) != SSRDECIM_OK)
+    {
+        ssrdecim_destroy(dec);
+        return NULL;
+    }
+
+    // a distinct signal on each channel, undone on the output: channel c is delayed by c * channel_delay frames
+    // (zero frames first) and the I/Q components are swapped on the odd channels
+    int16_t *frames_iq = malloc(2 * num_channels * (num_frames + 1) * sizeof(int16_t));
+    for (size_t n = 0; n < num_frames; ++n)
+    {
+        for (int c = 0; c < num_channels; ++c)
+        {
+            size_t delay = (size_t)c * channel_delay;
+            int16_t re = (n < delay) ? 0 : in_iq[2 * (n - delay)];
+            int16_t im = (n < delay) ? 0 : in_iq[2 * (n - delay) + 1];
+            int swap = swap_iq && (c & 1);
+            frames_iq[2 * (n * num_channels + c)] = swap ? im : re;
+            frames_iq[2 * (n * num_channels + c) + 1] = swap ? re : im;
+        }
+    }
+
+    int16_t *out_iq = malloc(2 * num_channels * (num_frames / dec_factor + 1) * sizeof(int16_t));
+    size_t n = 0;
+    *num_out = 0;
+    for (int block = 0; n < num_frames; ++block)
+    {
+        size_t block_size = 1 + (block * 37) % max_block_size;
+        if (block_size > num_frames - n)
+        {
+            block_size = num_frames - n;
+        }
+        *num_out += ssrdecim_process(dec, frames_iq + 2 * n * num_channels, block_size, out_iq + 2 * *num_out * num_channels);
+        n += block_size;
+    }
+
+    *errors += (*num_out != num_frames / dec_factor);
+    int16_t *out_ch0 = malloc(2 * (*num_out + 1) * sizeof(int16_t));
+    for (size_t i = 0; i < *num_out; ++i)
+    {
+        out_ch0[2 * i] = out_iq[2 * i * num_channels];
+        out_ch0[2 * i + 1] = out_iq[2 * i * num_channels + 1];
+    }
+    for (size_t i = 0; i < *num_out; ++i)
+    {
+        for (int c = 1; c < num_channels; ++c)
+        {
+            // output of channel 0 delayed by c * channel_delay / dec_factor frames (zero frames first)
+            size_t delay = (size_t)c * channel_delay / dec_factor;
+            int16_t re = (i < delay) ? 0 : out_ch0[2 * (i - delay)];
+            int16_t im = (i < delay) ? 0 : out_ch0[2 * (i - delay) + 1];
+            int swap = swap_iq && (c & 1);
+            const int16_t *frame = out_iq + 2 * (i * num_channels + c);
+            if (frame[swap ? 1 : 0] != re || frame[swap ? 0 : 1] != im)
+            {
+                (*errors)++;
+            }
+        }
+    }
+
+    ssrdecim_destroy(dec);
+    free(frames_iq);
+    free(out_iq);
+    return out_ch0;
+}
+
+int main(int argc, char **argv)
+{
+    if (ssrdecim_abi_version() != SSRDECIM_ABI_VERSION)
+    {
+        fprintf(stderr, "Error: library ABI version %d, expected %d\n", ssrdecim_abi_version(), SSRDECIM_ABI_VERSION);
+        return 1;
+    }
+
+    int errors = 0;
+
+    // compile-time options of the library (the reference vectors must match them)
+    int coef_bits = 0, dataout_bits = 0, dec2_fs4_shift = 0, dec4_fs4_shift = 0, unknown;
+    errors += (ssrdecim_option(SSRDECIM_OPT_COEF_BITS, &coef_bits) != SSRDECIM_OK);
+    errors += (ssrdecim_option(SSRDECIM_OPT_DATAOUT_BITS, &dataout_bits) != SSRDECIM_OK);
+    errors += (ssrdecim_option(SSRDECIM_OPT_DEC2_FS4_SHIFT, &dec2_fs4_shift) != SSRDECIM_OK);
+    errors += (ssrdecim_option(SSRDECIM_OPT_DEC4_FS4_SHIFT, &dec4_fs4_shift) != SSRDECIM_OK);
+    errors += (ssrdecim_option(-1, &unknown) != SSRDECIM_ERR_ARG);
+    printf("Library options: COEF_BITS %d, DATAOUT_BITS %d, DEC2_FS4_SHIFT %d, DEC4_FS4_SHIFT %d\n", coef_bits, dataout_bits,
+           dec2_fs4_shift, dec4_fs4_shift);
+
+    // -----------------------------------------------------
+    // Golden check: every decimation factor
+    // -----------------------------------------------------
+    // the I/Q swap does not commute with the fs/4 shifts (the rotation of the swapped signal is not the swapped rotation)
+    int swap_iq = (dec2_fs4_shift == 0 && dec4_fs4_shift == 0);
+
+    const int dec_factors[] = {1, 2, 4, 8, 16, 32, 64};
+    int golden_errors =
+        goldenCheck((argc > 1) ? argv[1] : "golden", dec_factors, sizeof(dec_factors) / sizeof(dec_factors[0]), decimate, &swap_iq);
+    if (golden_errors < 0)
+    {
+        return 1;
+    }
+    errors += golden_errors;
+
+    // -----------------------------------------------------
+    // Test case of the work folder (if any)
+    // -----------------------------------------------------
+    int dec_factor;
+    size_t num_frames, num_out;
+    int test_errors = runTestCase("work/output_lib.txt", decimate, &swap_iq, &dec_factor, &num_frames, &num_out);
+    if (test_errors < 0)
+    {
+        return 1;
+    }
+    errors += test_errors;
+    if (dec_factor)
+    {
+        printf("numSamplesInput: %zu, numSamplesOutput: %zu per channel\n", num_frames, num_out);
+    }
+
+    return testResult(errors);
+}